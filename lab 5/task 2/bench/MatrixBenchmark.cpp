@@ -0,0 +1,342 @@
+// Latency of the library's main operations: parsing, each operator across
+// sizes, toString, Evaluate on several tree shapes, StepEvaluate to the
+// end, VectorAnalog::sort with both comparers, and the loaders.
+//
+// Every case is timed in samples of one or more calls; a sample is at
+// least MIN_SAMPLE_NS long so that clock resolution does not matter. The
+// per-call latency of each sample feeds min, percentiles, max and mean. A
+// summary table goes to stderr and JSON to stdout (or to --json PATH), so
+// that the output of two builds can be diffed.
+//
+// Usage: MatrixBenchmark [--samples N] [--filter TEXT] [--json PATH]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ArithmeticExpression.h"
+#include "Comparers/DiagonalProductComparer.h"
+#include "Comparers/DiagonalProductThenNextComparer.h"
+#include "Loader.h"
+#include "Matrix.h"
+#include "Node.h"
+#include "VectorAnalog.h"
+
+static const double MIN_SAMPLE_NS = 100000;
+
+// Keeps results observable so the timed calls are not optimized away.
+static volatile double sink;
+
+struct BenchmarkCase {
+    std::string name;
+    // Runs before every timed call, untimed; a case with a setup is timed
+    // one call per sample.
+    std::function<void()> setup;
+    std::function<void()> body;
+};
+
+// Points stream at buffer until the end of the scope, even if it is left
+// by an exception.
+struct StreamRedirect {
+    std::ios& stream;
+    std::streambuf* saved;
+
+    StreamRedirect(std::ios& stream, std::streambuf* buffer)
+        : stream(stream), saved(stream.rdbuf(buffer)) {}
+    ~StreamRedirect() { stream.rdbuf(saved); }
+
+    StreamRedirect(const StreamRedirect&) = delete;
+    StreamRedirect& operator=(const StreamRedirect&) = delete;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t samples;
+    size_t callsPerSample;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double mean;
+};
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// Nearest-rank percentile of sorted values.
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.5);
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+static BenchmarkResult runCase(const BenchmarkCase& benchmark,
+                               size_t samples) {
+    size_t calls = 1;
+    if (!benchmark.setup) {
+        auto start = std::chrono::steady_clock::now();
+        benchmark.body();
+        double once = std::max(1.0, elapsedNs(start));
+        calls = std::max<size_t>(1, static_cast<size_t>(MIN_SAMPLE_NS / once));
+    }
+
+    std::vector<double> perCall;
+    perCall.reserve(samples);
+    for (size_t s = 0; s < samples; ++s) {
+        if (benchmark.setup) benchmark.setup();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < calls; ++c) benchmark.body();
+        perCall.push_back(elapsedNs(start) / calls);
+    }
+    std::sort(perCall.begin(), perCall.end());
+
+    double total = 0;
+    for (double value : perCall) total += value;
+    return {benchmark.name,           samples,
+            calls,                    perCall.front(),
+            percentile(perCall, 50),  percentile(perCall, 90),
+            percentile(perCall, 99),  perCall.back(),
+            total / perCall.size()};
+}
+
+static Matrix randomMatrix(size_t n, std::mt19937& generator) {
+    // Values in [1, 2): no division by zero and no overflow in any chain
+    // the cases build.
+    std::uniform_real_distribution<double> distribution(1.0, 2.0);
+    Matrix matrix(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) matrix(i, j) = distribution(generator);
+    }
+    return matrix;
+}
+
+static std::unique_ptr<Node> leaf(const Matrix& value) {
+    return std::make_unique<OperandNode>(value);
+}
+
+// ((m0 + m1) - m2) + ... with count leaves, alternating + and -.
+static std::unique_ptr<Node> leftDeepTree(const std::vector<Matrix>& leaves) {
+    std::unique_ptr<Node> root = leaf(leaves[0]);
+    for (size_t k = 1; k < leaves.size(); ++k) {
+        root = std::make_unique<OperatorNode>(k % 2 ? '+' : '-',
+                                              std::move(root),
+                                              leaf(leaves[k]));
+    }
+    return root;
+}
+
+// Perfectly balanced over leaves[begin, end), '+' inside and '*' at the
+// root of every pair.
+static std::unique_ptr<Node> balancedTree(const std::vector<Matrix>& leaves,
+                                          size_t begin, size_t end) {
+    if (end - begin == 1) return leaf(leaves[begin]);
+    size_t middle = begin + (end - begin) / 2;
+    return std::make_unique<OperatorNode>(
+        end - begin == 2 ? '*' : '+', balancedTree(leaves, begin, middle),
+        balancedTree(leaves, middle, end));
+}
+
+static std::vector<BenchmarkCase> buildCases(const std::string& scratchPath) {
+    std::mt19937 generator(42);
+    std::vector<BenchmarkCase> cases;
+    const size_t sizes[] = {4, 16, 64, 256};
+
+    for (size_t n : {4, 16, 64}) {
+        auto text = std::make_shared<std::string>(
+            randomMatrix(n, generator).toString());
+        cases.push_back({"parse/" + std::to_string(n), nullptr, [text] {
+                             Matrix parsed(text->c_str());
+                             sink = parsed(0, 0);
+                         }});
+        auto matrix = std::make_shared<Matrix>(randomMatrix(n, generator));
+        cases.push_back({"toString/" + std::to_string(n), nullptr, [matrix] {
+                             sink = matrix->toString().size();
+                         }});
+    }
+
+    for (size_t n : sizes) {
+        auto a = std::make_shared<Matrix>(randomMatrix(n, generator));
+        auto b = std::make_shared<Matrix>(randomMatrix(n, generator));
+        std::string suffix = "/" + std::to_string(n);
+        cases.push_back({"add" + suffix, nullptr,
+                         [a, b] { sink = (*a + *b)(0, 0); }});
+        cases.push_back({"subtract" + suffix, nullptr,
+                         [a, b] { sink = (*a - *b)(0, 0); }});
+        cases.push_back({"multiply" + suffix, nullptr,
+                         [a, b] { sink = (*a * *b)(0, 0); }});
+        cases.push_back({"divide" + suffix, nullptr,
+                         [a, b] { sink = (*a / *b)(0, 0); }});
+    }
+
+    for (size_t n : {3, 16, 64}) {
+        std::vector<Matrix> leaves;
+        for (size_t k = 0; k < 8; ++k) {
+            leaves.push_back(randomMatrix(n, generator));
+        }
+        std::string suffix = "/" + std::to_string(n);
+        auto chain =
+            std::make_shared<ArithmeticExpression>(leftDeepTree(leaves));
+        cases.push_back({"evaluate/chain8" + suffix, nullptr,
+                         [chain] { sink = chain->Evaluate()(0, 0); }});
+        auto balanced = std::make_shared<ArithmeticExpression>(
+            balancedTree(leaves, 0, leaves.size()));
+        cases.push_back({"evaluate/balanced8" + suffix, nullptr,
+                         [balanced] { sink = balanced->Evaluate()(0, 0); }});
+
+        auto stepped = std::make_shared<ArithmeticExpression>();
+        cases.push_back({"stepEvaluate/chain8" + suffix,
+                         [stepped, leaves] {
+                             *stepped = ArithmeticExpression(
+                                 leftDeepTree(leaves));
+                         },
+                         [stepped] {
+                             while (stepped->StepEvaluate()) {
+                             }
+                         }});
+    }
+
+    std::vector<Matrix> sortLeaves;
+    for (size_t k = 0; k < 128; ++k) {
+        sortLeaves.push_back(randomMatrix(8, generator));
+    }
+    auto expressions = std::make_shared<VectorAnalog>();
+    auto fillExpressions = [expressions, sortLeaves] {
+        *expressions = VectorAnalog();
+        for (size_t k = 0; k + 1 < sortLeaves.size(); k += 2) {
+            std::unique_ptr<Node> sum = std::make_unique<OperatorNode>(
+                '+', leaf(sortLeaves[k]), leaf(sortLeaves[k + 1]));
+            expressions->add(ArithmeticExpression(std::move(sum)));
+        }
+    };
+    cases.push_back({"sort/diagonalProduct/64", fillExpressions,
+                     [expressions] {
+                         expressions->sort(DiagonalProductComparer());
+                     }});
+    cases.push_back({"sort/diagonalProductThenNext/64", fillExpressions,
+                     [expressions] {
+                         expressions->sort(DiagonalProductThenNextComparer());
+                     }});
+
+    std::string fileText = randomMatrix(64, generator).toString();
+    {
+        std::ofstream scratch(scratchPath);
+        scratch << fileText << '\n';
+    }
+    auto fileLoader = std::make_shared<FileLoader>(scratchPath);
+    cases.push_back({"loader/file/64", nullptr, [fileLoader] {
+                         sink = fileLoader->GetItem()(0, 0);
+                     }});
+
+    // ConsoleLoader reads std::cin and prompts on std::cout; both are
+    // pointed at string streams for the call.
+    std::string consoleText = randomMatrix(16, generator).toString();
+    consoleText.erase(std::remove(consoleText.begin(), consoleText.end(), ' '),
+                      consoleText.end());
+    auto input = std::make_shared<std::istringstream>();
+    cases.push_back({"loader/console/16",
+                     [input, consoleText] {
+                         input->clear();
+                         input->str(consoleText);
+                     },
+                     [input] {
+                         std::ostringstream prompt;
+                         StreamRedirect redirectIn(std::cin, input->rdbuf());
+                         StreamRedirect redirectOut(std::cout, prompt.rdbuf());
+                         ConsoleLoader loader;
+                         sink = loader.GetItem()(0, 0);
+                     }});
+    return cases;
+}
+
+static void writeJson(std::ostream& out,
+                      const std::vector<BenchmarkResult>& results) {
+    out << std::fixed << std::setprecision(1);
+    out << "{\n  \"build\": {\"compiler\": \"" << __VERSION__
+        << "\", \"assertions\": "
+#ifdef NDEBUG
+        << "false"
+#else
+        << "true"
+#endif
+        << ", \"telemetry\": "
+#ifdef MATRIX_TELEMETRY
+        << "true"
+#else
+        << "false"
+#endif
+        << "},\n  \"unit\": \"ns\",\n  \"benchmarks\": [";
+    for (size_t k = 0; k < results.size(); ++k) {
+        const BenchmarkResult& r = results[k];
+        out << (k ? ",\n" : "\n") << "    {\"name\": \"" << r.name
+            << "\", \"samples\": " << r.samples
+            << ", \"calls_per_sample\": " << r.callsPerSample
+            << ", \"min\": " << r.min << ", \"p50\": " << r.p50
+            << ", \"p90\": " << r.p90 << ", \"p99\": " << r.p99
+            << ", \"max\": " << r.max << ", \"mean\": " << r.mean << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t samples = 30;
+    std::string filter;
+    std::string jsonPath;
+    for (int k = 1; k < argc; ++k) {
+        std::string option = argv[k];
+        if (k + 1 < argc && option == "--samples") {
+            samples = std::max<size_t>(1, std::strtoul(argv[++k], nullptr, 10));
+        } else if (k + 1 < argc && option == "--filter") {
+            filter = argv[++k];
+        } else if (k + 1 < argc && option == "--json") {
+            jsonPath = argv[++k];
+        } else {
+            std::cerr << "Usage: MatrixBenchmark [--samples N] "
+                         "[--filter TEXT] [--json PATH]\n";
+            return 1;
+        }
+    }
+
+    std::string scratchPath = "MatrixBenchmark.scratch.txt";
+    std::vector<BenchmarkResult> results;
+    std::cerr << std::left << std::setw(36) << "benchmark" << std::right
+              << std::setw(12) << "p50 ns" << std::setw(12) << "p90 ns"
+              << std::setw(12) << "p99 ns" << '\n';
+    try {
+        for (const BenchmarkCase& benchmark : buildCases(scratchPath)) {
+            if (benchmark.name.find(filter) == std::string::npos) continue;
+            results.push_back(runCase(benchmark, samples));
+            const BenchmarkResult& r = results.back();
+            std::cerr << std::left << std::setw(36) << r.name << std::right
+                      << std::fixed << std::setprecision(0) << std::setw(12)
+                      << r.p50 << std::setw(12) << r.p90 << std::setw(12)
+                      << r.p99 << '\n';
+        }
+    } catch (const std::exception& e) {
+        std::remove(scratchPath.c_str());
+        std::cerr << "Benchmark failed: " << e.what() << '\n';
+        return 1;
+    }
+    std::remove(scratchPath.c_str());
+
+    if (jsonPath.empty()) {
+        writeJson(std::cout, results);
+    } else {
+        std::ofstream out(jsonPath);
+        writeJson(out, results);
+    }
+    return 0;
+}
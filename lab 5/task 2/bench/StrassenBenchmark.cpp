@@ -0,0 +1,67 @@
+// Times blockedMultiply against strassenMultiply on random square matrices
+// to find where the recursion starts to pay off (STRASSEN_MIN_SIZE).
+//
+// Usage: StrassenBenchmark [max order, default 1024]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Strassen.h"
+
+template <typename F>
+static double bestMilliseconds(F run, int repeats) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxOrder = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+    std::cout << std::setw(6) << "n" << std::setw(14) << "blocked ms"
+              << std::setw(14) << "strassen ms" << std::setw(10) << "speedup"
+              << std::setw(14) << "max |diff|" << '\n';
+
+    for (size_t n = 128; n <= maxOrder; n += n < 512 ? 128 : 256) {
+        std::vector<double> a(n * n), b(n * n), classical(n * n),
+            fast(n * n);
+        for (double& value : a) value = distribution(generator);
+        for (double& value : b) value = distribution(generator);
+
+        int repeats = n <= 512 ? 5 : 2;
+        double blockedTime = bestMilliseconds(
+            [&] { blockedMultiply(a.data(), b.data(), classical.data(), n); },
+            repeats);
+        double strassenTime = bestMilliseconds(
+            [&] { strassenMultiply(a.data(), b.data(), fast.data(), n); },
+            repeats);
+
+        double maxDiff = 0;
+        for (size_t k = 0; k < n * n; ++k) {
+            maxDiff = std::max(maxDiff, std::abs(classical[k] - fast[k]));
+        }
+
+        std::cout << std::setw(6) << n << std::fixed << std::setprecision(2)
+                  << std::setw(14) << blockedTime << std::setw(14)
+                  << strassenTime << std::setw(10)
+                  << blockedTime / strassenTime << std::scientific
+                  << std::setprecision(2) << std::setw(14) << maxDiff
+                  << std::defaultfloat << '\n';
+    }
+    return 0;
+}
@@ -1,6 +1,8 @@
 #ifndef ARITHMETIC_EXPRESSION_H
 #define ARITHMETIC_EXPRESSION_H
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,6 +20,7 @@ class ArithmeticExpression {
 
    public:
     ArithmeticExpression();
+    explicit ArithmeticExpression(std::unique_ptr<Node> rootNode);
     ~ArithmeticExpression() = default;
 
     ArithmeticExpression(const ArithmeticExpression&) = delete;
@@ -32,24 +35,47 @@ class ArithmeticExpression {
 
     void switchLoader(std::unique_ptr<Loader> newLoader);
 
+    // Walks the operand leaves left to right in a single pass. The iterator
+    // keeps the operators on the path to the current leaf and climbs them
+    // to find the next one; it never writes to the tree, so several may
+    // walk the same expression at once. Each edge is walked down and up
+    // once over a full pass.
+    //
+    // Operands are read-only through the iterator: any non-const access to
+    // a Matrix counts as a write and would densify a sparse operand and
+    // drop its structure tag, even for a plain read.
     class Iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Matrix;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Matrix*;
+        using reference = const Matrix&;
+
        private:
-        std::vector<Matrix*> operands;
-        size_t index;
+        // Ancestors of the current leaf, root first.
+        std::vector<const OperatorNode*> path;
+        const Node* leaf;
+        const Matrix* current;
+
+        void descend(const Node* node);
 
        public:
-        Iterator(Node* rootNode, size_t idx = 0);
+        Iterator();
+        explicit Iterator(const Node* rootNode);
 
+        bool operator==(const Iterator& other) const;
         bool operator!=(const Iterator& other) const;
 
-        ArithmeticExpression& operator*() const;
-        ArithmeticExpression* operator->() const;
+        const Matrix& operator*() const;
+        const Matrix* operator->() const;
 
-        const Iterator& operator++();
+        Iterator& operator++();
+        Iterator operator++(int);
     };
 
-    Iterator begin();
-    Iterator end();
+    Iterator begin() const;
+    Iterator end() const;
 
     std::string PrintExpression() const;
 
@@ -63,6 +89,8 @@ class ArithmeticExpression {
 
     std::vector<Matrix*> getOperands() const;
 
+    const Node* getRoot() const;
+
    private:
     void replaceNode(Node* target, std::unique_ptr<Node> replacement);
 
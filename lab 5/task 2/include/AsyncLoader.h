@@ -0,0 +1,65 @@
+#ifndef ASYNC_LOADER_H
+#define ASYNC_LOADER_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Loader.h"
+
+// Decorator that reads ahead: a background thread calls the wrapped
+// loader's GetItem() and hands the parsed matrices over through a bounded
+// single-producer/single-consumer ring, so reading and parsing the next
+// operand overlaps whatever the caller does with the current one.
+//
+// At most capacity items are buffered; the reader then waits for the
+// consumer (backpressure). An exception from the wrapped loader is
+// rethrown by the GetItem() call that reaches its position, and by every
+// call after it; reading stops there. When the wrapped loader runs dry,
+// HasNext() turns false and GetItem() throws MatrixException.
+//
+// The wrapped loader must report CanReadAhead(): prefetching from one that
+// never runs dry would read forever, and one that prompts would do so
+// from the background. The constructor throws MatrixException otherwise.
+//
+// One consumer thread only. Destruction waits for the wrapped loader's
+// current GetItem() to return.
+class AsyncLoader : public Loader {
+private:
+    struct Slot {
+        Matrix value;
+        std::exception_ptr error;
+        bool end = false;
+    };
+
+    std::unique_ptr<Loader> source;
+    std::vector<Slot> slots;
+    // Items ever taken by the consumer and ever published by the reader;
+    // slot k lives in slots[k % slots.size()]. Both threads block on them
+    // with std::atomic wait/notify.
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<bool> stopping{false};
+    std::thread reader;
+
+    void readAhead();
+    bool publish(Slot&& slot);
+    const Slot& front();
+
+public:
+    explicit AsyncLoader(std::unique_ptr<Loader> source, size_t capacity = 4);
+    ~AsyncLoader() override;
+
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+    // Block until the next item (or the end) has been read.
+    Matrix GetItem() override;
+    bool HasNext() override;
+    bool CanReadAhead() const override;
+};
+
+#endif // ASYNC_LOADER_H
@@ -0,0 +1,55 @@
+#ifndef CHECKED_ARITHMETIC_H
+#define CHECKED_ARITHMETIC_H
+
+#include "ElementOps.h"
+#include "MatrixException.h"
+
+// ElementOps<T> results turned into the MatrixException each kernel
+// reports. Shared by the Matrix and MatrixView kernels.
+
+// a + b or a - b with the element type's overflow check.
+template <typename T>
+inline T addOrThrow(T a, T b, bool subtract) {
+    T result;
+    bool ok = subtract ? ElementOps<T>::subtract(a, b, result)
+                       : ElementOps<T>::add(a, b, result);
+    if (!ok) {
+        throw MatrixOverflowException(subtract ? "Subtraction overflow"
+                                               : "Addition overflow");
+    }
+    return result;
+}
+
+// sum += a * b, checking the product (and, for integers, the sum).
+template <typename T>
+inline void multiplyAddOrThrow(T& sum, T a, T b) {
+    T product;
+    if (!ElementOps<T>::multiply(a, b, product) ||
+        !ElementOps<T>::accumulate(sum, product)) {
+        throw MatrixOverflowException("Multiplication overflow");
+    }
+}
+
+template <typename T>
+inline T multiplyOrThrow(T a, T b) {
+    T result;
+    if (!ElementOps<T>::multiply(a, b, result)) {
+        throw MatrixOverflowException("Multiplication overflow");
+    }
+    return result;
+}
+
+template <typename T>
+inline T divideOrThrow(T a, T b) {
+    if (ElementOps<T>::isZeroDivisor(b)) {
+        throw MatrixDivisionByZeroException(
+            "Division by zero in matrix element");
+    }
+    T result;
+    if (!ElementOps<T>::divide(a, b, result)) {
+        throw MatrixOverflowException("Division overflow");
+    }
+    return result;
+}
+
+#endif  // CHECKED_ARITHMETIC_H
@@ -2,14 +2,23 @@
 #define DIAGONAL_PRODUCT_COMPARER_H
 
 #include <stdexcept>
+#include <vector>
 
 #include "../ArithmeticExpression.h"
 #include "../IComparer.h"
+#include "../VectorAnalog.h"
 
 class DiagonalProductComparer : public IComparer<ArithmeticExpression> {
    public:
     virtual int Compare(const ArithmeticExpression& o1,
                         const ArithmeticExpression& o2) const override;
+
+    // The value Compare orders by, for every expression at once: each one
+    // is evaluated a single time (on threadCount threads, 0 for all
+    // hardware threads) instead of twice per comparison. Pass the result
+    // to VectorAnalog::sortByKeys.
+    static std::vector<double> keys(const VectorAnalog& expressions,
+                                    size_t threadCount = 0);
 };
 
 #endif  // DIAGONAL_PRODUCT_COMPARER_H
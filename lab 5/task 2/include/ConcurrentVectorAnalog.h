@@ -0,0 +1,55 @@
+#ifndef CONCURRENT_VECTOR_ANALOG_H
+#define CONCURRENT_VECTOR_ANALOG_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "ArithmeticExpression.h"
+#include "VectorAnalog.h"
+
+// Append-only container that many threads can add to without locks. Storage
+// is a table of segments whose sizes double (64, 128, 256, ...); a slot is
+// claimed with a compare-and-swap on the size once its segment exists, and
+// segments are never moved, so references to stored expressions stay valid
+// until freeze() or destruction.
+class ConcurrentVectorAnalog {
+   private:
+    static const size_t FIRST_SEGMENT_SIZE = 64;
+    static const size_t MAX_SEGMENTS = 48;
+
+    std::atomic<ArithmeticExpression*> segments[MAX_SEGMENTS];
+    std::atomic<size_t> size_;
+
+    static size_t segmentOf(size_t index);
+    static size_t segmentStart(size_t segment);
+    static size_t segmentSize(size_t segment);
+
+    ArithmeticExpression* ensureSegment(size_t segment);
+    void clear();
+
+   public:
+    ConcurrentVectorAnalog();
+    ~ConcurrentVectorAnalog();
+
+    ConcurrentVectorAnalog(const ConcurrentVectorAnalog&) = delete;
+    ConcurrentVectorAnalog& operator=(const ConcurrentVectorAnalog&) = delete;
+
+    // Safe to call from any number of threads at once. Returns the index the
+    // expression was stored at.
+    size_t add(ArithmeticExpression&& expr);
+
+    // Only valid for indices whose add() happened-before this call (returned
+    // on this thread, or the producing thread has been joined).
+    ArithmeticExpression& operator[](size_t index);
+    const ArithmeticExpression& operator[](size_t index) const;
+
+    // Number of claimed slots, including adds that are still in progress.
+    size_t size() const;
+
+    // Moves every expression into a contiguous VectorAnalog (a pointer move
+    // per element) and leaves this container empty. Must not run
+    // concurrently with add().
+    VectorAnalog freeze();
+};
+
+#endif  // CONCURRENT_VECTOR_ANALOG_H
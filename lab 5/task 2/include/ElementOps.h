@@ -0,0 +1,121 @@
+#ifndef ELEMENT_OPS_H
+#define ELEMENT_OPS_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Checked element arithmetic for BasicMatrix<T>. Every operation returns
+// false instead of producing an out-of-range value, and the matrix kernels
+// turn that into the matching MatrixException.
+//
+// Floating-point types use the range checks Matrix has always used; the
+// running sum of a product is left unchecked, as before. int64_t uses the
+// compiler's overflow builtins (a flag test after the hardware add/mul) and
+// checks every step, since a wrapped integer would be silently wrong.
+template <typename T, typename Enable = void>
+struct ElementOps;
+
+template <typename T>
+struct ElementOps<T, std::enable_if_t<std::is_floating_point<T>::value>> {
+    static bool add(T a, T b, T& out) {
+        const T max = std::numeric_limits<T>::max();
+        if ((b > 0 && a > max - b) || (b < 0 && a < -max - b)) return false;
+        out = a + b;
+        return true;
+    }
+
+    static bool subtract(T a, T b, T& out) { return add(a, -b, out); }
+
+    static bool multiply(T a, T b, T& out) {
+        if (a != 0 && b != 0 &&
+            std::abs(a) > std::numeric_limits<T>::max() / std::abs(b)) {
+            return false;
+        }
+        out = a * b;
+        return true;
+    }
+
+    static bool accumulate(T& sum, T value) {
+        sum += value;
+        return true;
+    }
+
+    static bool isZeroDivisor(T b) { return std::abs(b) < T(1e-10); }
+
+    static bool divide(T a, T b, T& out) {
+        out = a / b;
+        return true;
+    }
+
+    template <typename U>
+    static bool convert(U value, T& out) {
+        if (std::is_floating_point<U>::value && std::isfinite(value) &&
+            std::abs(static_cast<long double>(value)) >
+                std::numeric_limits<T>::max()) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+
+    // Throws std::invalid_argument / std::out_of_range like std::stod.
+    static T parse(const std::string& text) {
+        if (std::is_same<T, float>::value) return std::stof(text);
+        return static_cast<T>(std::stod(text));
+    }
+};
+
+template <>
+struct ElementOps<int64_t> {
+    static bool add(int64_t a, int64_t b, int64_t& out) {
+        return !__builtin_add_overflow(a, b, &out);
+    }
+
+    static bool subtract(int64_t a, int64_t b, int64_t& out) {
+        return !__builtin_sub_overflow(a, b, &out);
+    }
+
+    static bool multiply(int64_t a, int64_t b, int64_t& out) {
+        return !__builtin_mul_overflow(a, b, &out);
+    }
+
+    static bool accumulate(int64_t& sum, int64_t value) {
+        return !__builtin_add_overflow(sum, value, &sum);
+    }
+
+    static bool isZeroDivisor(int64_t b) { return b == 0; }
+
+    static bool divide(int64_t a, int64_t b, int64_t& out) {
+        if (a == std::numeric_limits<int64_t>::min() && b == -1) return false;
+        out = a / b;
+        return true;
+    }
+
+    // Floating-point values are truncated toward zero, like static_cast.
+    template <typename U>
+    static bool convert(U value, int64_t& out) {
+        if (std::is_floating_point<U>::value) {
+            if (!(value >= -9223372036854775808.0 &&
+                  value < 9223372036854775808.0)) {
+                return false;
+            }
+        }
+        out = static_cast<int64_t>(value);
+        return true;
+    }
+
+    static int64_t parse(const std::string& text) {
+        size_t used = 0;
+        long long value = std::stoll(text, &used);
+        if (text.find_first_not_of(" \t\r\n", used) != std::string::npos) {
+            throw std::invalid_argument(text);
+        }
+        return value;
+    }
+};
+
+#endif  // ELEMENT_OPS_H
@@ -0,0 +1,177 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include <cfloat>
+#include <cstddef>
+#include <utility>
+
+#include "Matrix.h"
+#include "MatrixException.h"
+
+// Matrix whose shape is part of the type. Elements live inline (no heap),
+// every operation is constexpr, and the kernels are expanded over an index
+// sequence so there are no runtime loops at all. The operators follow
+// Matrix's Strict OverflowCheckMode rules and throw the same exceptions.
+// The *Unchecked variants skip every per-element test, for callers in a
+// deferred mode that verify the result afterwards as Matrix does.
+template <size_t R, size_t C>
+class FixedMatrix {
+   private:
+    double values[R * C];
+
+    static constexpr double absolute(double x) { return x < 0 ? -x : x; }
+
+    template <bool Checked>
+    static constexpr double sum(double a, double b, const char* what) {
+        if constexpr (Checked) {
+            if ((b > 0 && a > DBL_MAX - b) || (b < 0 && a < -DBL_MAX - b)) {
+                throw MatrixOverflowException(what);
+            }
+        }
+        return a + b;
+    }
+
+    template <bool Checked>
+    static constexpr double product(double a, double b) {
+        if constexpr (Checked) {
+            if (a != 0 && b != 0 && absolute(a) > DBL_MAX / absolute(b)) {
+                throw MatrixOverflowException("Multiplication overflow");
+            }
+        }
+        return a * b;
+    }
+
+    template <bool Checked>
+    static constexpr double quotient(double a, double b) {
+        if constexpr (Checked) {
+            if (absolute(b) < 1e-10) {
+                throw MatrixDivisionByZeroException(
+                    "Division by zero in matrix element");
+            }
+        }
+        return a / b;
+    }
+
+    template <bool Checked, size_t... I>
+    constexpr FixedMatrix add(const FixedMatrix& other, double sign,
+                              const char* what,
+                              std::index_sequence<I...>) const {
+        FixedMatrix result;
+        ((result.values[I] =
+              sum<Checked>(values[I], sign * other.values[I], what)),
+         ...);
+        return result;
+    }
+
+    template <bool Checked, size_t... I>
+    constexpr FixedMatrix divide(const FixedMatrix& other,
+                                 std::index_sequence<I...>) const {
+        FixedMatrix result;
+        ((result.values[I] =
+              quotient<Checked>(values[I], other.values[I])),
+         ...);
+        return result;
+    }
+
+    template <bool Checked, size_t... K>
+    constexpr double dot(const FixedMatrix& other, size_t i, size_t j,
+                         std::index_sequence<K...>) const {
+        double total = 0;
+        ((total += product<Checked>(values[i * C + K],
+                                    other.values[K * C + j])),
+         ...);
+        return total;
+    }
+
+    template <bool Checked, size_t... I>
+    constexpr FixedMatrix multiply(const FixedMatrix& other,
+                                   std::index_sequence<I...>) const {
+        static_assert(R == C, "FixedMatrix product needs a square shape");
+        FixedMatrix result;
+        ((result.values[I] = dot<Checked>(other, I / C, I % C,
+                                          std::make_index_sequence<C>{})),
+         ...);
+        return result;
+    }
+
+   public:
+    constexpr FixedMatrix() : values{} {}
+
+    explicit FixedMatrix(const Matrix& matrix) : values{} {
+        if (matrix.getRows() != R || matrix.getCols() != C) {
+            throw MatrixDimensionMismatchException(
+                "Matrix shape does not match FixedMatrix");
+        }
+        for (size_t i = 0; i < R; ++i) {
+            for (size_t j = 0; j < C; ++j) {
+                values[i * C + j] = matrix(i, j);
+            }
+        }
+    }
+
+    Matrix toMatrix() const { return Matrix(values, R, C); }
+
+    static constexpr size_t getRows() { return R; }
+    static constexpr size_t getCols() { return C; }
+
+    constexpr double& operator()(size_t row, size_t col) {
+        return values[row * C + col];
+    }
+
+    constexpr const double& operator()(size_t row, size_t col) const {
+        return values[row * C + col];
+    }
+
+    // Row-major, R * C values.
+    constexpr const double* data() const { return values; }
+
+    constexpr FixedMatrix operator+(const FixedMatrix& other) const {
+        return add<true>(other, 1.0, "Addition overflow",
+                         std::make_index_sequence<R * C>{});
+    }
+
+    constexpr FixedMatrix operator-(const FixedMatrix& other) const {
+        return add<true>(other, -1.0, "Subtraction overflow",
+                         std::make_index_sequence<R * C>{});
+    }
+
+    // Like Matrix, both operands must have the same (square) shape.
+    constexpr FixedMatrix operator*(const FixedMatrix& other) const {
+        return multiply<true>(other, std::make_index_sequence<R * C>{});
+    }
+
+    constexpr FixedMatrix operator/(const FixedMatrix& other) const {
+        return divide<true>(other, std::make_index_sequence<R * C>{});
+    }
+
+    constexpr FixedMatrix addUnchecked(const FixedMatrix& other) const {
+        return add<false>(other, 1.0, nullptr,
+                          std::make_index_sequence<R * C>{});
+    }
+
+    constexpr FixedMatrix subtractUnchecked(const FixedMatrix& other) const {
+        return add<false>(other, -1.0, nullptr,
+                          std::make_index_sequence<R * C>{});
+    }
+
+    constexpr FixedMatrix multiplyUnchecked(const FixedMatrix& other) const {
+        return multiply<false>(other, std::make_index_sequence<R * C>{});
+    }
+
+    constexpr FixedMatrix divideUnchecked(const FixedMatrix& other) const {
+        return divide<false>(other, std::make_index_sequence<R * C>{});
+    }
+
+    constexpr bool operator==(const FixedMatrix& other) const {
+        for (size_t i = 0; i < R * C; ++i) {
+            if (values[i] != other.values[i]) return false;
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const FixedMatrix& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif  // FIXED_MATRIX_H
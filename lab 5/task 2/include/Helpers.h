@@ -1,11 +1,43 @@
 #ifndef HELPERS_H
 #define HELPERS_H
 
+#include <span>
+#include <vector>
+
 #include "Matrix.h"
 #include "MatrixException.h"
+#include "MatrixView.h"
+
+// Instantiated for Matrix, FloatMatrix and Int64Matrix. The integer version
+// throws MatrixOverflowException instead of wrapping.
+template <typename T>
+T calculateDiagonalProduct(const BasicMatrix<T>& matrix);
+
+template <typename T>
+int compareMatricesLex(const BasicMatrix<T>& m1, const BasicMatrix<T>& m2);
+
+// calculateDiagonalProduct of every matrix, spread over threadCount threads
+// (0: one per hardware thread). Each product reads only the two diagonals.
+// For many small matrices of one order, PackedMatrixBatch is faster still.
+template <typename T>
+std::vector<T> calculateDiagonalProducts(
+    std::span<const BasicMatrix<T>> matrices, size_t threadCount = 0);
+
+// T cannot be deduced through the span conversion, so a vector has its own
+// overload.
+template <typename T>
+std::vector<T> calculateDiagonalProducts(
+    const std::vector<BasicMatrix<T>>& matrices, size_t threadCount = 0) {
+    return calculateDiagonalProducts(
+        std::span<const BasicMatrix<T>>(matrices), threadCount);
+}
 
-double calculateDiagonalProduct(const Matrix& matrix);
+// The same over views, so blocks and transposes need no copy.
+template <typename T>
+T calculateDiagonalProduct(const BasicMatrixView<T>& view);
 
-int compareMatricesLex(const Matrix& m1, const Matrix& m2);
+template <typename T>
+int compareMatricesLex(const BasicMatrixView<T>& m1,
+                       const BasicMatrixView<T>& m2);
 
 #endif  // HELPERS_H
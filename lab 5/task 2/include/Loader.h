@@ -9,6 +9,13 @@ class Loader {
 public:
     virtual ~Loader() = default;
     virtual Matrix GetItem() = 0;
+    // False once GetItem has nothing more to return. ConsoleLoader and
+    // FileLoader never run dry.
+    virtual bool HasNext() { return true; }
+    // True if the loader runs dry on its own and never waits on a person,
+    // so that AsyncLoader may drive it from a background thread. Neither
+    // holds for ConsoleLoader and FileLoader.
+    virtual bool CanReadAhead() const { return false; }
 };
 
 class ConsoleLoader : public Loader {
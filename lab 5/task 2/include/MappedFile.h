@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Read-only view of a whole file. Uses mmap on POSIX systems so the pages are
+// loaded on demand; elsewhere it falls back to reading the file into memory.
+class MappedFile {
+   public:
+    // How the pages will be touched; passed to the kernel as a read-ahead
+    // hint. Random suits lookups that jump around a large file.
+    enum class Access { Sequential, Random };
+
+   private:
+    const char* data_;
+    size_t size_;
+    std::unique_ptr<char[]> buffer;
+
+    void unmap();
+
+   public:
+    explicit MappedFile(const std::string& path,
+                        Access access = Access::Sequential);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const;
+    size_t size() const;
+};
+
+#endif  // MAPPED_FILE_H
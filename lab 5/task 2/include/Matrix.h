@@ -2,70 +2,293 @@
 #define MATRIX_H
 
 #include "MatrixException.h"
+#include "SparseStorage.h"
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
-class Matrix {
+// What is known about where a square matrix's non-zeros can be. Scalar is
+// c * I. General makes no promise; it is also what any writable element
+// access falls back to.
+enum class MatrixStructure {
+    General,
+    Diagonal,
+    UpperTriangular,
+    LowerTriangular,
+    Identity,
+    Scalar
+};
+
+// Whole-matrix reductions, computed in one pass on first use and kept until
+// the matrix is written to. Diagonals run over i < min(rows, cols); the
+// anti-diagonal element of row i is (i, cols - 1 - i). For int64_t a sum
+// that does not fit is flagged instead of thrown, so the rest of the
+// summary stays usable.
+template <typename T>
+struct MatrixSummary {
+    T sum;
+    T trace;
+    T antiTrace;
+    // trace * antiTrace, the key of DiagonalProductComparer for a square
+    // matrix. Unchecked for floating point, as calculateDiagonalProduct is.
+    T diagonalProduct;
+    T min;
+    T max;
+    // Depends only on the dimensions and the non-zero elements, so equal
+    // dense and sparse matrices hash alike.
+    size_t hash;
+    bool sumOverflowed;
+    bool diagonalsOverflowed;
+    // Set with diagonalsOverflowed, or when only the product does not fit.
+    bool diagonalProductOverflowed;
+};
+
+template <typename T>
+class BasicMatrixView;
+
+class MatrixAllocator;
+
+// Dense/sparse matrix over an element type T. Instantiated for float, double
+// and int64_t (see the end of Matrix.cpp); element arithmetic and its
+// overflow rules come from ElementOps<T>.
+template <typename T>
+class BasicMatrix {
 private:
-    double** data;
+    template <typename U>
+    friend class BasicMatrix;
+    friend class BasicMatrixView<T>;
+
+    // Matrices of up to INLINE_CAPACITY elements keep their values in
+    // inlineStorage, so creating, copying and moving them never touches the
+    // heap.
+    static constexpr size_t INLINE_CAPACITY = 16;
+
+    // Exactly one of elements (dense, row-major) and sparse (CSR) is set
+    // for a non-empty matrix. selectFormat() picks between them by density.
+    T* elements;
+    // Made the heap buffer behind elements; see MatrixAllocator.h.
+    MatrixAllocator* allocator;
     size_t rows;
     size_t cols;
-    
+    std::unique_ptr<SparseStorage<T>> sparse;
+    MatrixStructure structure;
+    T inlineStorage[INLINE_CAPACITY];
+
+    // Filled by summary(); every member that can change an element clears
+    // summaryValid. Not synchronized: two threads must not take the first
+    // summary of the same matrix at once.
+    mutable MatrixSummary<T> summaryCache;
+    mutable bool summaryValid = false;
+
     void allocateMemory();
     void deallocateMemory();
-    void copyData(const Matrix& other);
+    void copyData(const BasicMatrix& other);
+    void takeData(BasicMatrix& other);
+
+    T sum() const;
+    void computeSummary() const;
+
+    T valueAt(size_t row, size_t col) const;
+    void detectStructure();
+    void finishResult(MatrixStructure kind);
+    void selectFormat();
+    void toSparse();
+    void toDense();
+
+    // Everything a writable element reference needs first: dense storage,
+    // no structure promise and no cached summary.
+    bool readyForWrite() const {
+        return !sparse && structure == MatrixStructure::General &&
+               !summaryValid;
+    }
+    void prepareWrite();
+    const T& sparseValue(size_t row, size_t col) const;
+
+    BasicMatrix addSparse(const BasicMatrix& other, bool subtract) const;
+    BasicMatrix multiplySparse(const BasicMatrix& other) const;
+    BasicMatrix divideSparse(const BasicMatrix& other) const;
+    BasicMatrix addDiagonal(const BasicMatrix& other, bool subtract) const;
+    BasicMatrix scaleRows(const BasicMatrix& other) const;
+    BasicMatrix scaleColumns(const BasicMatrix& other) const;
+    BasicMatrix multiplyTriangular(const BasicMatrix& other) const;
 
-    double sum() const;
-    bool willOverflow(double a, double b) const;
+    // Computes *this op other (other op *this when reversed), op being one
+    // of '+', '-' and '/', into this matrix's own dense storage. Returns
+    // false without touching anything when that cannot be done exactly like
+    // the copying operator would: a sparse operand, mismatched shapes, or a
+    // deferred division that would overwrite its own divisors.
+    bool combineInPlace(const BasicMatrix& other, char op, bool reversed);
+
+    // left op right for op in "+-/". spareLeft and spareRight, when set,
+    // point at operands the caller no longer needs; the result takes over
+    // the storage of the first one that combineInPlace() accepts.
+    static BasicMatrix combineReusing(const BasicMatrix& left,
+                                      const BasicMatrix& right, char op,
+                                      BasicMatrix* spareLeft,
+                                      BasicMatrix* spareRight);
+
+    template <typename U>
+    friend BasicMatrix<U> operator+(const BasicMatrix<U>& left,
+                                    BasicMatrix<U>&& right);
+    template <typename U>
+    friend BasicMatrix<U> operator-(const BasicMatrix<U>& left,
+                                    BasicMatrix<U>&& right);
+    template <typename U>
+    friend BasicMatrix<U> operator/(const BasicMatrix<U>& left,
+                                    BasicMatrix<U>&& right);
 
 public:
-    Matrix();
-    Matrix(size_t r, size_t c);
-    Matrix(double** arr, size_t r, size_t c);
-    Matrix(double num);
-    Matrix(const char* str);
-    Matrix(const Matrix& other);
-    Matrix(Matrix&& other) noexcept;
-    ~Matrix();
-
-    Matrix& operator=(const Matrix& other);
-    Matrix& operator=(Matrix&& other) noexcept;
-    
-    Matrix operator+(const Matrix& other) const;
-    Matrix operator-(const Matrix& other) const;
-    Matrix operator*(const Matrix& other) const;
-    Matrix operator/(const Matrix& other) const;
+    using value_type = T;
+
+    BasicMatrix();
+    BasicMatrix(size_t r, size_t c);
+    BasicMatrix(T** arr, size_t r, size_t c);
+    BasicMatrix(const T* values, size_t r, size_t c);
+    BasicMatrix(T num);
+    BasicMatrix(const char* str);
+    BasicMatrix(const BasicMatrix& other);
+    BasicMatrix(BasicMatrix&& other) noexcept;
+    ~BasicMatrix();
 
-    Matrix operator+(const char* str) const;
-    friend Matrix operator+(const char* str, const Matrix& matrix);
+    // Element type conversion. Throws MatrixOverflowException if a value
+    // does not fit the target type; floating-point to int64_t truncates.
+    template <typename U>
+    explicit BasicMatrix(const BasicMatrix<U>& other);
 
-    Matrix operator-(const char* str) const;
-    friend Matrix operator-(const char* str, const Matrix& matrix);
+    BasicMatrix& operator=(const BasicMatrix& other);
+    BasicMatrix& operator=(BasicMatrix&& other) noexcept;
+    
+    BasicMatrix operator+(const BasicMatrix& other) const&;
+    BasicMatrix operator-(const BasicMatrix& other) const&;
+    BasicMatrix operator*(const BasicMatrix& other) const;
+    BasicMatrix operator/(const BasicMatrix& other) const&;
 
-    Matrix operator*(const char* str) const;
-    friend Matrix operator*(const char* str, const Matrix& matrix);
+    // A temporary operand lends its buffer to the result, so a chain such
+    // as a + b + c - d allocates once. Products have no such overload: every
+    // output element reads a whole row and column of both operands.
+    BasicMatrix operator+(const BasicMatrix& other) &&;
+    BasicMatrix operator+(BasicMatrix&& other) &&;
+    BasicMatrix operator-(const BasicMatrix& other) &&;
+    BasicMatrix operator-(BasicMatrix&& other) &&;
+    BasicMatrix operator/(const BasicMatrix& other) &&;
+    BasicMatrix operator/(BasicMatrix&& other) &&;
 
-    Matrix operator/(const char* str) const;
-    friend Matrix operator/(const char* str, const Matrix& matrix);
+    // str is parsed as by BasicMatrix(const char*). Recently used strings
+    // are remembered per thread, so a literal repeated in a loop is parsed
+    // once; for a literal known at compile time see MatrixLiteral.h.
+    BasicMatrix operator+(const char* str) const;
+    BasicMatrix operator-(const char* str) const;
+    BasicMatrix operator*(const char* str) const;
+    BasicMatrix operator/(const char* str) const;
 
-    Matrix& operator+=(const Matrix& other);
-    Matrix& operator-=(const Matrix& other);
-    Matrix& operator*=(const Matrix& other);
-    Matrix& operator/=(const Matrix& other);
+    BasicMatrix& operator+=(const BasicMatrix& other);
+    BasicMatrix& operator-=(const BasicMatrix& other);
+    BasicMatrix& operator*=(const BasicMatrix& other);
+    BasicMatrix& operator/=(const BasicMatrix& other);
     
-    bool operator==(const Matrix& other) const;
-    bool operator!=(const Matrix& other) const;
-    bool operator<(const Matrix& other) const;
-    bool operator>(const Matrix& other) const;
-    bool operator<=(const Matrix& other) const;
-    bool operator>=(const Matrix& other) const;
+    bool operator==(const BasicMatrix& other) const;
+    bool operator!=(const BasicMatrix& other) const;
+    bool operator<(const BasicMatrix& other) const;
+    bool operator>(const BasicMatrix& other) const;
+    bool operator<=(const BasicMatrix& other) const;
+    bool operator>=(const BasicMatrix& other) const;
     
     std::string toString() const;
 
-    double& operator()(size_t row, size_t col);
-    const double& operator()(size_t row, size_t col) const;
+    // Unchecked element access: the bounds are only asserted, so release
+    // builds (NDEBUG) compile a dense read down to a single load. Use at()
+    // for a range check.
+    //
+    // NOTE: the non-const overload means "write". It cannot tell a read
+    // from a write, so every call on a non-const matrix converts CSR
+    // storage to dense, resets the structure to General and drops the
+    // cached summary, even when the element is only read. Read through a
+    // const reference (std::as_const(m)(i, j)) to keep them. The same holds
+    // for the non-const at(), data() and row().
+    T& operator()(size_t row, size_t col) {
+        assert(row < rows && col < cols);
+        if (!readyForWrite()) prepareWrite();
+        return elements[row * cols + col];
+    }
+    const T& operator()(size_t row, size_t col) const {
+        assert(row < rows && col < cols);
+        if (sparse) return sparseValue(row, col);
+        return elements[row * cols + col];
+    }
+
+    // Checked access; throws MatrixException("Index out of bounds").
+    T& at(size_t row, size_t col);
+    const T& at(size_t row, size_t col) const;
+
+    // Row-major dense storage: element (i, j) is data()[i * stride() + j].
+    // The writable overloads densify like operator(); the const ones throw
+    // MatrixException for a sparse matrix.
+    T* data();
+    const T* data() const;
+    size_t stride() const;
+
+    // One row of data(); index is only asserted.
+    std::span<T> row(size_t index);
+    std::span<const T> row(size_t index) const;
+
+    // Matrix-vector product; vector.size() must equal getCols(). Sparse
+    // matrices only touch their non-zeros.
+    std::vector<T> multiplyVector(const std::vector<T>& vector) const;
 
     size_t getRows() const;
     size_t getCols() const;
+
+    bool isSparse() const;
+    size_t nonZeros() const;
+
+    MatrixStructure getStructure() const;
+
+    // O(rows * cols) the first time, O(1) until the next write.
+    const MatrixSummary<T>& summary() const;
+    // True while summary() would return without recomputing.
+    bool hasSummary() const;
+
+    // Whole-matrix view (see MatrixView.h); throws for sparse matrices.
+    BasicMatrixView<T> view() const;
 };
 
+// The right-hand temporary counterparts of the && member operators.
+template <typename T>
+BasicMatrix<T> operator+(const BasicMatrix<T>& left, BasicMatrix<T>&& right);
+
+template <typename T>
+BasicMatrix<T> operator-(const BasicMatrix<T>& left, BasicMatrix<T>&& right);
+
+template <typename T>
+BasicMatrix<T> operator/(const BasicMatrix<T>& left, BasicMatrix<T>&& right);
+
+template <typename T>
+BasicMatrix<T> operator+(const char* str, const BasicMatrix<T>& matrix);
+
+template <typename T>
+BasicMatrix<T> operator-(const char* str, const BasicMatrix<T>& matrix);
+
+template <typename T>
+BasicMatrix<T> operator*(const char* str, const BasicMatrix<T>& matrix);
+
+template <typename T>
+BasicMatrix<T> operator/(const char* str, const BasicMatrix<T>& matrix);
+
+namespace std {
+template <typename T>
+struct hash<BasicMatrix<T>> {
+    size_t operator()(const BasicMatrix<T>& matrix) const {
+        return matrix.summary().hash;
+    }
+};
+}  // namespace std
+
+using Matrix = BasicMatrix<double>;
+using FloatMatrix = BasicMatrix<float>;
+using Int64Matrix = BasicMatrix<int64_t>;
+
 #endif // MATRIX_H
@@ -0,0 +1,87 @@
+#ifndef MATRIX_ALLOCATOR_H
+#define MATRIX_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Source of the heap buffers behind dense matrices with more than
+// INLINE_CAPACITY elements. A matrix returns its buffer to the allocator
+// that made it, so that allocator must outlive the buffer.
+class MatrixAllocator {
+   public:
+    virtual ~MatrixAllocator() = default;
+
+    // At least 64-byte aligned; throws std::bad_alloc on failure.
+    virtual void* allocate(size_t bytes) = 0;
+    // bytes is the value the block was allocated with.
+    virtual void deallocate(void* block, size_t bytes) = 0;
+};
+
+// The global heap, as Matrix used before allocators were pluggable.
+class HeapMatrixAllocator : public MatrixAllocator {
+   public:
+    void* allocate(size_t bytes) override;
+    void deallocate(void* block, size_t bytes) override;
+};
+
+// Counters for the calling thread's pool.
+struct MatrixPoolStats {
+    // Requests that fit a size class, and how many of them a free list
+    // served without going to the heap.
+    uint64_t pooledRequests;
+    uint64_t poolHits;
+    // Requests above the largest size class; the hugePage ones were at
+    // least HUGE_PAGE_SIZE and were aligned and advised for huge pages.
+    uint64_t largeRequests;
+    uint64_t hugePageRequests;
+    // Bytes currently held in this thread's free lists.
+    size_t retainedBytes;
+    // Blocks freed on other threads and taken back into this pool.
+    uint64_t remoteFrees;
+
+    double hitRate() const {
+        return pooledRequests ? double(poolHits) / pooledRequests : 0.0;
+    }
+};
+
+// The default allocator. Requests up to MAX_POOLED_BYTES are rounded up to
+// a power-of-two size class and recycled through per-thread free lists, so
+// the short-lived temporaries of an expression neither reach the global
+// heap nor contend on it. Each thread retains at most MAX_RETAINED_BYTES
+// and releases the rest, and everything at thread exit.
+//
+// By default a matrix gets its thread's own pool from getMatrixAllocator()
+// (see threadAllocator()), so a buffer freed on another thread, as when a
+// loader thread produces matrices for a consumer, goes back to the pool
+// that made it through a lock-free hand-off list. Producers therefore keep
+// hitting their pool. Blocks passed to an explicitly installed
+// PoolMatrixAllocator join the freeing thread's lists instead.
+//
+// Larger requests go straight to the heap, 64-byte aligned. From
+// HUGE_PAGE_SIZE up they are aligned to that size and, where the platform
+// supports it, advised to be backed by transparent huge pages.
+class PoolMatrixAllocator : public MatrixAllocator {
+   public:
+    static constexpr size_t MIN_POOLED_BYTES = 64;
+    static constexpr size_t MAX_POOLED_BYTES = 64 * 1024;
+    static constexpr size_t MAX_RETAINED_BYTES = 4 * 1024 * 1024;
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* block, size_t bytes) override;
+
+    // The calling thread's pool; the heap once the thread's pool has been
+    // released at exit.
+    static MatrixAllocator* threadAllocator();
+
+    static MatrixPoolStats threadStats();
+    // Returns the calling thread's retained blocks to the heap.
+    static void trim();
+};
+
+// Allocator for matrix buffers created from now on; nullptr restores the
+// default, PoolMatrixAllocator::threadAllocator(). Process-wide.
+void setMatrixAllocator(MatrixAllocator* allocator);
+MatrixAllocator* getMatrixAllocator();
+
+#endif  // MATRIX_ALLOCATOR_H
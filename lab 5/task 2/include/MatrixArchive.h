@@ -0,0 +1,83 @@
+#ifndef MATRIX_ARCHIVE_H
+#define MATRIX_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Loader.h"
+#include "MappedFile.h"
+
+// Binary store of many matrices that are fetched by id, the order they
+// were appended in. The file holds the row-major values of every matrix
+// back to back, then an index of one {offset, rows, cols, checksum} record
+// per id, then a fixed-size footer pointing at the index. Appending needs
+// only the index in memory, and reading any id costs one index lookup and
+// one read of that matrix's values, whatever the size of the archive.
+//
+// Native byte order, like VectorAnalog snapshots; a file written on a
+// machine of the other order is rejected as unsupported.
+struct MatrixArchiveEntry {
+    uint64_t offset;
+    uint64_t rows;
+    uint64_t cols;
+    // 64-bit FNV-1a over the value words.
+    uint64_t checksum;
+};
+
+class MatrixArchiveWriter {
+private:
+    std::string path;
+    std::ofstream out;
+    std::vector<MatrixArchiveEntry> index;
+    uint64_t offset;
+    std::vector<double> row;
+    bool finished;
+
+public:
+    // Throws MatrixException if path cannot be created.
+    explicit MatrixArchiveWriter(const std::string& path);
+    // Finishes the archive if finish() was not called; errors are lost.
+    ~MatrixArchiveWriter();
+
+    MatrixArchiveWriter(const MatrixArchiveWriter&) = delete;
+    MatrixArchiveWriter& operator=(const MatrixArchiveWriter&) = delete;
+
+    // Returns the id of the stored matrix.
+    uint64_t append(const Matrix& matrix);
+
+    // Writes the index and footer and closes the file. Nothing can be
+    // appended afterwards. Throws MatrixException if writing failed.
+    void finish();
+};
+
+class MatrixArchiveLoader : public Loader {
+private:
+    MappedFile file;
+    const MatrixArchiveEntry* index;
+    uint64_t count;
+    uint64_t valuesEnd;
+    // Next id for the sequential GetItem().
+    uint64_t cursor;
+
+public:
+    // Checks the header, footer and index bounds up front. Throws
+    // MatrixException if the file is missing or not a complete archive.
+    explicit MatrixArchiveLoader(const std::string& path);
+
+    uint64_t size() const;
+    const MatrixArchiveEntry& entry(uint64_t id) const;
+
+    // Throws MatrixException for an unknown id, and for values that are
+    // out of bounds or fail their checksum.
+    Matrix GetItem(uint64_t id) const;
+
+    // Ids 0, 1, ... in turn, so the archive also works as a plain Loader.
+    Matrix GetItem() override;
+    bool HasNext() override;
+    bool CanReadAhead() const override;
+};
+
+#endif // MATRIX_ARCHIVE_H
@@ -0,0 +1,173 @@
+#ifndef MATRIX_LITERAL_H
+#define MATRIX_LITERAL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "FixedMatrix.h"
+#include "MatrixException.h"
+
+struct MatrixLiteralShape {
+    size_t rows;
+    size_t cols;
+};
+
+// The text of a "[...]"_mat literal, held so that it can be a template
+// argument. The grammar is Matrix(const char*)'s: rows separated by ';',
+// elements by ','. Elements are decimal numbers with an optional sign,
+// fraction and exponent; blanks around them are ignored.
+//
+// Parsing happens during constant evaluation, so a malformed literal is a
+// compile error naming the exception Matrix(const char*) would throw. An
+// element is only accepted if it can be rounded exactly here: at most 2^53
+// as an integer significand and a power of ten within 1e±22, which covers
+// ordinary literals. Anything else has to go through Matrix(const char*).
+template <size_t N>
+struct MatrixLiteralText {
+    char text[N];
+
+    consteval MatrixLiteralText(const char (&str)[N]) : text{} {
+        for (size_t i = 0; i < N; ++i) text[i] = str[i];
+    }
+
+    consteval MatrixLiteralShape shape() const {
+        if (N < 3 || text[0] != '[' || text[N - 2] != ']') {
+            throw InvalidMatrixFormatException(
+                "Matrix must start with '[' and end with ']'");
+        }
+        MatrixLiteralShape result{1, 1};
+        size_t rowCols = 1;
+        for (size_t k = 1; k < N - 2; ++k) {
+            if (text[k] == ',') {
+                rowCols++;
+            } else if (text[k] == ';') {
+                if (result.rows == 1) result.cols = rowCols;
+                if (rowCols != result.cols) {
+                    throw InvalidMatrixFormatException(
+                        "Inconsistent number of columns");
+                }
+                result.rows++;
+                rowCols = 1;
+            }
+        }
+        if (result.rows == 1) result.cols = rowCols;
+        if (rowCols != result.cols) {
+            throw InvalidMatrixFormatException(
+                "Inconsistent number of columns");
+        }
+        return result;
+    }
+
+    template <size_t R, size_t C>
+    consteval FixedMatrix<R, C> toFixed() const {
+        FixedMatrix<R, C> result;
+        size_t begin = 1;
+        size_t index = 0;
+        for (size_t k = 1; k <= N - 2; ++k) {
+            if (k == N - 2 || text[k] == ',' || text[k] == ';') {
+                result(index / C, index % C) = element(begin, k);
+                index++;
+                begin = k + 1;
+            }
+        }
+        return result;
+    }
+
+   private:
+    static constexpr uint64_t MAX_EXACT_SIGNIFICAND = uint64_t(1) << 53;
+
+    static consteval bool isBlank(char c) { return c == ' ' || c == '\t'; }
+    static consteval bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static consteval double powerOfTen(int exponent) {
+        double result = 1;
+        for (int i = 0; i < exponent; ++i) result *= 10;
+        return result;
+    }
+
+    // text[begin, end) as a double, rounded as std::stod would.
+    consteval double element(size_t begin, size_t end) const {
+        while (begin < end && isBlank(text[begin])) begin++;
+        while (end > begin && isBlank(text[end - 1])) end--;
+
+        size_t k = begin;
+        bool negative = false;
+        if (k < end && (text[k] == '+' || text[k] == '-')) {
+            negative = text[k] == '-';
+            k++;
+        }
+
+        uint64_t significand = 0;
+        int exponent = 0;
+        bool anyDigit = false;
+        bool inFraction = false;
+        for (; k < end; ++k) {
+            if (text[k] == '.' && !inFraction) {
+                inFraction = true;
+                continue;
+            }
+            if (!isDigit(text[k])) break;
+            anyDigit = true;
+            significand = significand * 10 + (text[k] - '0');
+            if (significand > MAX_EXACT_SIGNIFICAND) {
+                throw InvalidMatrixFormatException(
+                    "Literal element has too many digits to round exactly");
+            }
+            if (inFraction) exponent--;
+        }
+        if (!anyDigit) {
+            throw InvalidMatrixFormatException(
+                "Non-numeric value encountered");
+        }
+
+        if (k < end && (text[k] == 'e' || text[k] == 'E')) {
+            k++;
+            bool negativeExponent = false;
+            if (k < end && (text[k] == '+' || text[k] == '-')) {
+                negativeExponent = text[k] == '-';
+                k++;
+            }
+            int written = 0;
+            bool anyExponentDigit = false;
+            for (; k < end && isDigit(text[k]); ++k) {
+                anyExponentDigit = true;
+                if (written < 1000) written = written * 10 + (text[k] - '0');
+            }
+            if (!anyExponentDigit) {
+                throw InvalidMatrixFormatException(
+                    "Non-numeric value encountered");
+            }
+            exponent += negativeExponent ? -written : written;
+        }
+        if (k != end) {
+            throw InvalidMatrixFormatException(
+                "Non-numeric value encountered");
+        }
+
+        double value = static_cast<double>(significand);
+        if (significand != 0) {
+            if (exponent < -22 || exponent > 22) {
+                throw InvalidMatrixFormatException(
+                    "Literal element exponent is out of the exact range");
+            }
+            // Both factors are exact doubles, so the single multiplication
+            // or division rounds correctly.
+            value = exponent < 0 ? value / powerOfTen(-exponent)
+                                 : value * powerOfTen(exponent);
+        }
+        return negative ? -value : value;
+    }
+};
+
+namespace matrix_literals {
+
+// "[1,2;3,4]"_mat is a FixedMatrix<2, 2>, built entirely at compile time.
+template <MatrixLiteralText S>
+consteval auto operator""_mat() {
+    constexpr MatrixLiteralShape shape = S.shape();
+    return S.template toFixed<shape.rows, shape.cols>();
+}
+
+}  // namespace matrix_literals
+
+#endif  // MATRIX_LITERAL_H
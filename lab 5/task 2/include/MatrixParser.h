@@ -0,0 +1,20 @@
+#ifndef MATRIX_PARSER_H
+#define MATRIX_PARSER_H
+
+#include <string_view>
+
+#include "Matrix.h"
+
+// Parses the text format of Matrix(const char*) in a single pass over the
+// characters with std::from_chars: no copy of the text, no streams and no
+// locale. This is the parser for bulk input, where Matrix(const char*)
+// spends most of its time building stringstreams.
+//
+// text must be exactly one matrix, "[1,2;3,4]"; blanks around elements are
+// ignored. Errors throw what Matrix(const char*) throws. Unlike it, anything
+// other than blanks after a number ("1x", or "1.5" for int64_t) is rejected
+// rather than silently dropped.
+template <typename T>
+BasicMatrix<T> parseMatrix(std::string_view text);
+
+#endif  // MATRIX_PARSER_H
@@ -0,0 +1,141 @@
+#ifndef MATRIX_VIEW_H
+#define MATRIX_VIEW_H
+
+#include <cassert>
+#include <cstddef>
+
+#include "Matrix.h"
+
+// Non-owning, read-only window onto a dense BasicMatrix: element (i, j) is
+// data[i * rowStride + j * colStride]. Blocks, rows, columns and transposes
+// are views of the same storage, so taking one never copies. A view must
+// not outlive the matrix it was taken from. Sparse matrices have no dense
+// storage to view and throw MatrixException.
+//
+// The arithmetic operators and comparisons follow the BasicMatrix rules
+// (equal dimensions, the same exceptions) and accept any mix of views and
+// matrices. They use the Strict overflow checks.
+//
+// Views are only taken explicitly (BasicMatrix::view() or the converting
+// constructor), and never of a temporary matrix, so that
+// MatrixView v = a + b; does not compile instead of dangling.
+template <typename T>
+class BasicMatrixView {
+   private:
+    const T* data;
+    size_t rows;
+    size_t cols;
+    size_t rowStride;
+    size_t colStride;
+
+    static BasicMatrix<T> add(const BasicMatrixView& a,
+                              const BasicMatrixView& b, bool subtract);
+    static BasicMatrix<T> multiply(const BasicMatrixView& a,
+                                   const BasicMatrixView& b);
+    static BasicMatrix<T> divide(const BasicMatrixView& a,
+                                 const BasicMatrixView& b);
+    static bool equal(const BasicMatrixView& a, const BasicMatrixView& b);
+
+   public:
+    BasicMatrixView(const T* data, size_t rows, size_t cols, size_t rowStride,
+                    size_t colStride);
+    explicit BasicMatrixView(const BasicMatrix<T>& matrix);
+    BasicMatrixView(const BasicMatrix<T>&&) = delete;
+
+    size_t getRows() const;
+    size_t getCols() const;
+    size_t getRowStride() const;
+    size_t getColStride() const;
+
+    // Unchecked (asserted) like BasicMatrix::operator(); at() checks.
+    const T& operator()(size_t row, size_t col) const {
+        assert(row < rows && col < cols);
+        return data[row * rowStride + col * colStride];
+    }
+    const T& at(size_t row, size_t col) const;
+
+    BasicMatrixView block(size_t firstRow, size_t firstCol, size_t rowCount,
+                          size_t colCount) const;
+    BasicMatrixView row(size_t index) const;
+    BasicMatrixView column(size_t index) const;
+    BasicMatrixView transpose() const;
+
+    // Copies the viewed elements into a new matrix. Strided layouts such as
+    // transposes go through a cache-oblivious recursive copy.
+    BasicMatrix<T> toMatrix() const;
+
+    T sum() const;
+
+    friend BasicMatrix<T> operator+(const BasicMatrixView& a,
+                                    const BasicMatrixView& b) {
+        return add(a, b, false);
+    }
+    friend BasicMatrix<T> operator-(const BasicMatrixView& a,
+                                    const BasicMatrixView& b) {
+        return add(a, b, true);
+    }
+    friend BasicMatrix<T> operator*(const BasicMatrixView& a,
+                                    const BasicMatrixView& b) {
+        return multiply(a, b);
+    }
+    friend BasicMatrix<T> operator/(const BasicMatrixView& a,
+                                    const BasicMatrixView& b) {
+        return divide(a, b);
+    }
+
+    friend bool operator==(const BasicMatrixView& a, const BasicMatrixView& b) {
+        return equal(a, b);
+    }
+    friend bool operator!=(const BasicMatrixView& a, const BasicMatrixView& b) {
+        return !equal(a, b);
+    }
+    friend bool operator<(const BasicMatrixView& a, const BasicMatrixView& b) {
+        return a.sum() < b.sum();
+    }
+    friend bool operator>(const BasicMatrixView& a, const BasicMatrixView& b) {
+        return a.sum() > b.sum();
+    }
+    friend bool operator<=(const BasicMatrixView& a, const BasicMatrixView& b) {
+        return a.sum() <= b.sum();
+    }
+    friend bool operator>=(const BasicMatrixView& a, const BasicMatrixView& b) {
+        return a.sum() >= b.sum();
+    }
+
+    // A matrix operand, temporaries included, is viewed only for the
+    // duration of the call.
+#define MATRIX_VIEW_MIXED_OPERATOR(Result, op)                            \
+    friend Result operator op(const BasicMatrixView& a,                   \
+                              const BasicMatrix<T>& b) {                  \
+        return a op BasicMatrixView(b);                                   \
+    }                                                                     \
+    friend Result operator op(const BasicMatrix<T>& a,                    \
+                              const BasicMatrixView& b) {                 \
+        return BasicMatrixView(a) op b;                                   \
+    }
+    MATRIX_VIEW_MIXED_OPERATOR(BasicMatrix<T>, +)
+    MATRIX_VIEW_MIXED_OPERATOR(BasicMatrix<T>, -)
+    MATRIX_VIEW_MIXED_OPERATOR(BasicMatrix<T>, *)
+    MATRIX_VIEW_MIXED_OPERATOR(BasicMatrix<T>, /)
+    MATRIX_VIEW_MIXED_OPERATOR(bool, ==)
+    MATRIX_VIEW_MIXED_OPERATOR(bool, !=)
+    MATRIX_VIEW_MIXED_OPERATOR(bool, <)
+    MATRIX_VIEW_MIXED_OPERATOR(bool, >)
+    MATRIX_VIEW_MIXED_OPERATOR(bool, <=)
+    MATRIX_VIEW_MIXED_OPERATOR(bool, >=)
+#undef MATRIX_VIEW_MIXED_OPERATOR
+};
+
+// Copies a rows x cols strided source into row-major dst (row stride
+// dstStride), splitting the larger side until a tile fits in cache. The
+// access pattern is cache-friendly for any source strides, in particular a
+// transpose, without knowing the cache size.
+template <typename T>
+void copyCacheOblivious(const T* src, size_t srcRowStride, size_t srcColStride,
+                        T* dst, size_t dstStride, size_t rows, size_t cols);
+
+using MatrixView = BasicMatrixView<double>;
+using FloatMatrixView = BasicMatrixView<float>;
+using Int64MatrixView = BasicMatrixView<int64_t>;
+
+#endif  // MATRIX_VIEW_H
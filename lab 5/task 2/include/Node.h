@@ -30,6 +30,7 @@ private:
 
 public:
     explicit OperandNode(const Matrix& val);
+    explicit OperandNode(Matrix&& val);
 
     bool isOperator() const override;
 
@@ -42,6 +43,7 @@ public:
     void collectOperands(std::vector<Matrix*>& operandsVec) override;
 
     const Matrix& getValue() const;
+    Matrix& getValue();
 };
 
 class OperatorNode : public Node {
@@ -65,6 +67,9 @@ public:
 
     char getOperator() const;
 
+    // Name of this node's trace spans, e.g. "OperatorNode +".
+    const char* getTraceName() const;
+
     Node* getLeft() const;
     Node* getRight() const;
 
@@ -0,0 +1,54 @@
+#ifndef OVERFLOW_CHECK_H
+#define OVERFLOW_CHECK_H
+
+#include <cfenv>
+#include <cstddef>
+
+// How the floating-point Matrix kernels detect overflow and division by
+// zero. Int64Matrix always uses Strict checks.
+//
+// Strict tests every operand before the operation, as Matrix always has.
+// The other two modes run the kernel without branches and inspect the
+// result afterwards, throwing the same exception types. They only report
+// what IEEE arithmetic reports: a result that rounds to infinity, or a
+// divisor that is exactly zero (Strict also rejects |divisor| < 1e-10).
+enum class OverflowCheckMode {
+    Strict,
+    // Clears and then tests FE_OVERFLOW, FE_DIVBYZERO and FE_INVALID.
+    FloatingPointStatus,
+    // Scans the result for infinities and NaNs.
+    FiniteScan
+};
+
+// Process-wide; Strict by default.
+void setOverflowCheckMode(OverflowCheckMode mode);
+OverflowCheckMode getOverflowCheckMode();
+
+// Wraps one unchecked kernel run in a deferred mode. The floating-point
+// status the caller had is restored on destruction.
+class DeferredOverflowCheck {
+   private:
+    OverflowCheckMode mode;
+    fexcept_t savedFlags;
+
+   public:
+    DeferredOverflowCheck();
+    explicit DeferredOverflowCheck(OverflowCheckMode mode);
+    ~DeferredOverflowCheck();
+
+    DeferredOverflowCheck(const DeferredOverflowCheck&) = delete;
+    DeferredOverflowCheck& operator=(const DeferredOverflowCheck&) = delete;
+
+    // Throws MatrixOverflowException(overflowMessage), or
+    // MatrixDivisionByZeroException when divisors holds a zero, if the
+    // kernel that wrote values[0..count) overflowed.
+    template <typename T>
+    void finish(const T* values, size_t count, const char* overflowMessage,
+                const T* divisors = nullptr) const;
+};
+
+// Index of the first infinity or NaN in values, or count if all are finite.
+template <typename T>
+size_t findNonFinite(const T* values, size_t count);
+
+#endif  // OVERFLOW_CHECK_H
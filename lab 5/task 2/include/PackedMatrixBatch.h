@@ -0,0 +1,40 @@
+#ifndef PACKED_MATRIX_BATCH_H
+#define PACKED_MATRIX_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Matrix.h"
+
+// Many square matrices of the same order stored structure-of-arrays:
+// element (i, j) of every matrix sits in one contiguous lane, so a kernel
+// that visits (i, j) walks all matrices with unit stride and vectorizes
+// across the batch instead of gathering from separate allocations.
+template <typename T>
+class PackedMatrixBatch {
+   private:
+    size_t order_;
+    size_t capacity_;
+    size_t size_;
+    std::vector<T> values;
+
+    size_t lane(size_t row, size_t col) const;
+
+   public:
+    PackedMatrixBatch(size_t order, size_t capacity);
+
+    // Throws MatrixDimensionMismatchException for a matrix of another
+    // shape, and MatrixException once capacity() matrices were added.
+    void add(const BasicMatrix<T>& matrix);
+
+    size_t order() const;
+    size_t size() const;
+    size_t capacity() const;
+
+    T operator()(size_t index, size_t row, size_t col) const;
+
+    // calculateDiagonalProduct of every matrix, in insertion order.
+    std::vector<T> diagonalProducts(size_t threadCount = 0) const;
+};
+
+#endif  // PACKED_MATRIX_BATCH_H
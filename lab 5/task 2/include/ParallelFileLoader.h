@@ -0,0 +1,92 @@
+#ifndef PARALLEL_FILE_LOADER_H
+#define PARALLEL_FILE_LOADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Loader.h"
+#include "MappedFile.h"
+
+// Loader for large files holding one matrix per line. The file is mapped,
+// cut at line boundaries into chunks of about chunkBytes, and worker
+// threads parse whole chunks with parseMatrix() while the consumer takes
+// matrices from the chunks already done. Blank lines are skipped and a
+// trailing '\r' is ignored.
+//
+// With Order::Preserve, matrices come out in file order. Order::Any hands
+// out each chunk as soon as it is parsed, which keeps every worker busy
+// when chunk costs differ; lines inside a chunk stay in order either way.
+//
+// Workers stay at most two chunks per thread ahead of the consumer, so
+// memory use does not grow with the file. A parse error is rethrown by the
+// GetItem() call that reaches the failing line, and by every call after
+// it. At the end of the file HasNext() turns false and GetItem() throws
+// MatrixException. One consumer thread only.
+class ParallelFileLoader : public Loader {
+public:
+    enum class Order { Preserve, Any };
+
+    static constexpr size_t DEFAULT_CHUNK_BYTES = size_t(1) << 20;
+
+private:
+    struct Chunk {
+        size_t begin;
+        size_t end;
+        std::vector<Matrix> items;
+        // Set after the items parsed before the failing line.
+        std::exception_ptr error;
+        bool ready = false;
+        size_t taken = 0;
+
+        Chunk(size_t begin, size_t end) : begin(begin), end(end) {}
+    };
+
+    MappedFile file;
+    Order order;
+    std::vector<Chunk> chunks;
+    size_t window;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t nextToParse = 0;
+    // Chunks handed to a worker and not yet used up by the consumer.
+    size_t inFlight = 0;
+    // Chunks used up by the consumer; with Order::Preserve also the index
+    // of the current one.
+    size_t finished = 0;
+    // Parsed chunks in completion order, for Order::Any.
+    std::deque<size_t> readyChunks;
+    std::exception_ptr failure;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void splitChunks(size_t chunkBytes);
+    void work();
+    void parseChunk(Chunk& chunk, std::vector<Matrix>& items,
+                    std::exception_ptr& error) const;
+    Chunk* currentChunk(std::unique_lock<std::mutex>& lock);
+
+public:
+    // threadCount 0 means one worker per hardware thread. Throws
+    // MatrixException if path cannot be read.
+    explicit ParallelFileLoader(const std::string& path,
+                                Order order = Order::Preserve,
+                                size_t threadCount = 0,
+                                size_t chunkBytes = DEFAULT_CHUNK_BYTES);
+    ~ParallelFileLoader() override;
+
+    ParallelFileLoader(const ParallelFileLoader&) = delete;
+    ParallelFileLoader& operator=(const ParallelFileLoader&) = delete;
+
+    Matrix GetItem() override;
+    bool HasNext() override;
+    bool CanReadAhead() const override;
+};
+
+#endif // PARALLEL_FILE_LOADER_H
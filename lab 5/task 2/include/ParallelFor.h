@@ -0,0 +1,56 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Calls body(begin, end) on contiguous slices of [0, count), one slice per
+// thread. threadCount 0 means one per hardware thread; no thread gets fewer
+// than minPerThread items, so small batches stay on the calling thread.
+// The first exception thrown by any slice is rethrown after all threads
+// have joined. If a thread cannot be started, the ones already running are
+// joined before that error propagates.
+template <typename Body>
+void parallelFor(size_t count, size_t threadCount, size_t minPerThread,
+                 Body body) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount,
+                           std::max<size_t>(1, count / minPerThread));
+    if (threadCount <= 1) {
+        body(size_t(0), count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(threadCount);
+    size_t slice = (count + threadCount - 1) / threadCount;
+    threads.reserve(threadCount);
+    try {
+        for (size_t t = 0; t < threadCount; ++t) {
+            size_t begin = std::min(count, t * slice);
+            size_t end = std::min(count, begin + slice);
+            threads.emplace_back([&body, &errors, t, begin, end] {
+                try {
+                    body(begin, end);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+    } catch (...) {
+        // A joinable std::thread must not be destroyed.
+        for (std::thread& thread : threads) thread.join();
+        throw;
+    }
+    for (std::thread& thread : threads) thread.join();
+    for (const std::exception_ptr& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+#endif  // PARALLEL_FOR_H
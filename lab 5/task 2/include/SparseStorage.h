@@ -0,0 +1,29 @@
+#ifndef SPARSE_STORAGE_H
+#define SPARSE_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed sparse row (CSR) storage. The non-zeros of row i are
+// values[rowPtr[i] .. rowPtr[i + 1]) at columns colIndex[...], sorted by
+// column. Explicit zeros are never stored, so two equal matrices always have
+// identical arrays. Instantiated for the BasicMatrix element types.
+template <typename T>
+struct SparseStorage {
+    std::vector<T> values;
+    std::vector<size_t> colIndex;
+    std::vector<size_t> rowPtr;
+
+    explicit SparseStorage(size_t rows = 0);
+
+    size_t nonZeros() const;
+
+    // Returns nullptr if the element is an implicit zero.
+    const T* find(size_t row, size_t col) const;
+
+    void append(size_t col, T value);
+    void endRow();
+};
+
+#endif  // SPARSE_STORAGE_H
@@ -0,0 +1,50 @@
+#ifndef STDIN_LOADER_H
+#define STDIN_LOADER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "Loader.h"
+
+// Batch counterpart of ConsoleLoader for piped input. It reads the
+// descriptor in large raw blocks, bypassing iostreams, and parses each
+// matrix in place with parseMatrix(). Matrices are separated by any
+// whitespace, as with ConsoleLoader, and may contain blanks themselves
+// ("[1, 2; 3, 4]").
+//
+// When the descriptor is a terminal, ConsoleLoader's prompt is printed
+// whenever more input is needed. Otherwise nothing is printed, so the
+// loader can sit in the middle of a pipeline. At end of input HasNext()
+// turns false and GetItem() throws MatrixException.
+//
+// Input is read ahead of the matrix being returned, so do not also read
+// the same descriptor through std::cin.
+class StdinLoader : public Loader {
+public:
+    static constexpr size_t BLOCK_BYTES = size_t(1) << 20;
+
+private:
+    int fd;
+    bool interactive;
+    bool prompted;
+    bool atEnd;
+    std::vector<char> buffer;
+    // Unconsumed input is buffer[begin, end).
+    size_t begin;
+    size_t end;
+
+    bool fill();
+    std::string_view nextToken();
+
+public:
+    // Reads standard input unless another descriptor is given.
+    explicit StdinLoader(int fd = 0);
+
+    Matrix GetItem() override;
+    bool HasNext() override;
+    // Only when the descriptor is not a terminal.
+    bool CanReadAhead() const override;
+};
+
+#endif // STDIN_LOADER_H
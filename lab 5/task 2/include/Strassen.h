@@ -0,0 +1,46 @@
+#ifndef STRASSEN_H
+#define STRASSEN_H
+
+#include <cstddef>
+
+// Square floating-point products of order n >= STRASSEN_MIN_SIZE go
+// through strassenMultiply; below it the blocked classical kernel is
+// faster. The deferred OverflowCheckModes verify the result afterwards.
+// Strict mode has no per-term check to offer inside the recursion, so it
+// only takes Strassen when strassenGrowthBound() proves that nothing can
+// overflow, and keeps the checked classical kernel otherwise. The
+// recursion itself stops at STRASSEN_CUTOFF. Both values come from
+// bench/StrassenBenchmark.cpp.
+const size_t STRASSEN_MIN_SIZE = 256;
+const size_t STRASSEN_CUTOFF = 64;
+
+// c = a * b for row-major n x n operands, classical O(n^3) in cache-sized
+// blocks. c must not alias a or b.
+template <typename T>
+void blockedMultiply(const T* a, const T* b, T* c, size_t n);
+
+// c = a * b for row-major n x n operands using the Strassen-Winograd
+// recursion (7 half-size products and 15 additions per level). Odd orders
+// are peeled: the even leading block recurses and the last row and column
+// are patched up classically in O(n^2). Scratch memory is allocated once
+// and is at most 2/3 n^2 elements. c must not alias a or b.
+//
+// Error bound (Higham, Accuracy and Stability of Numerical Algorithms,
+// 2nd ed., sec. 23.2.2): with unit roundoff u and recursion stopping at n0,
+//     ||C - C'|| <= [(n/n0)^log2(18) (n0^2 + 6 n0) - 6n] u ||A|| ||B||
+// in the max norm, up to O(u^2). Unlike the classical kernel the bound is
+// only normwise, so small entries of C can lose all relative accuracy when
+// A or B have entries of very different magnitude. Intermediate sums can
+// also overflow where the classical product would not.
+template <typename T>
+void strassenMultiply(const T* a, const T* b, T* c, size_t n);
+
+// Upper bound on the magnitude of every value strassenMultiply computes
+// for order n, intermediates included, in units of max|a| * max|b|. Each
+// level sums up to four quadrants of either operand and up to four
+// half-size products, and the odd-order patch-up adds sums of at most n
+// terms, so the bound is 2 n 64^levels. It is loose, but a product whose
+// operands stay below it cannot overflow in either kernel.
+double strassenGrowthBound(size_t n);
+
+#endif  // STRASSEN_H
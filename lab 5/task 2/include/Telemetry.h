@@ -0,0 +1,103 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Process-wide operation counters. Each thread increments its own shard
+// with plain relaxed stores, so counting never contends; a snapshot adds
+// up the shards of live threads and what exited threads left behind.
+//
+// Counting is compiled in only when MATRIX_TELEMETRY is defined (the CMake
+// option of the same name, on by default). Without it MATRIX_COUNT expands
+// to nothing and every snapshot reads zero.
+enum class Counter {
+    // Heap buffers taken by dense matrices, and their total size.
+    MatrixAllocations,
+    MatrixBytes,
+    // Nominal work of matrix products: 2 * n^3 for n x n operands,
+    // whatever kernel or shortcut actually ran.
+    MultiplyFlops,
+    // Kernel runs checked element by element, and runs checked afterwards
+    // in a deferred OverflowCheckMode.
+    StrictOverflowChecks,
+    DeferredOverflowChecks,
+    // OperatorNode::evaluate calls.
+    NodeEvaluations,
+    // Loader::GetItem results and the length of the text they parsed.
+    LoaderItems,
+    LoaderBytes,
+    // VectorAnalog orderings (sort, sortByKeys, partialSort, nthElement)
+    // and the comparisons they made.
+    Sorts,
+    SortComparisons,
+    Count
+};
+
+constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::Count);
+
+// snake_case name used by TelemetrySnapshot::toText().
+const char* counterName(Counter counter);
+
+class TelemetrySnapshot {
+   private:
+    uint64_t values[COUNTER_COUNT] = {};
+
+   public:
+    static TelemetrySnapshot take();
+
+    uint64_t operator[](Counter counter) const {
+        return values[static_cast<size_t>(counter)];
+    }
+
+    // What happened between earlier and this snapshot.
+    TelemetrySnapshot operator-(const TelemetrySnapshot& earlier) const;
+
+    // One "name value" line per counter, in Counter order.
+    std::string toText() const;
+};
+
+struct TelemetryShard {
+    std::atomic<uint64_t> values[COUNTER_COUNT] = {};
+};
+
+// Adds a thread's shard to the snapshot set for the thread's lifetime and
+// folds its totals into the process totals when the thread exits.
+class TelemetryRegistration {
+   private:
+    TelemetryShard& shard;
+
+   public:
+    explicit TelemetryRegistration(TelemetryShard& shard);
+    ~TelemetryRegistration();
+
+    TelemetryRegistration(const TelemetryRegistration&) = delete;
+    TelemetryRegistration& operator=(const TelemetryRegistration&) = delete;
+};
+
+inline TelemetryShard& localTelemetryShard() {
+    // The shard is trivially destructible, so late counts during thread
+    // exit are still safe; they are just not reported.
+    thread_local TelemetryShard shard;
+    thread_local TelemetryRegistration registration(shard);
+    return shard;
+}
+
+inline void countTelemetry(Counter counter, uint64_t amount) {
+    // Only this thread writes the shard, so no read-modify-write is needed.
+    std::atomic<uint64_t>& value =
+        localTelemetryShard().values[static_cast<size_t>(counter)];
+    value.store(value.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
+#ifdef MATRIX_TELEMETRY
+#define MATRIX_COUNT(counter, amount) \
+    countTelemetry(Counter::counter, (amount))
+#else
+#define MATRIX_COUNT(counter, amount) ((void)0)
+#endif
+
+#endif  // TELEMETRY_H
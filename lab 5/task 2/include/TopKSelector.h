@@ -0,0 +1,45 @@
+#ifndef TOP_K_SELECTOR_H
+#define TOP_K_SELECTOR_H
+
+#include <vector>
+
+#include "ArithmeticExpression.h"
+#include "IComparer.h"
+#include "VectorAnalog.h"
+
+// Keeps the k smallest expressions (by comparer order) seen so far in a
+// bounded max-heap, so a stream of n expressions costs O(n log k) comparisons
+// and never holds more than k of them. Storage grows with the expressions
+// actually kept, so a large k over a short stream costs only min(k, n).
+class TopKSelector {
+   private:
+    std::vector<ArithmeticExpression> heap;
+    size_t limit;
+    const IComparer<ArithmeticExpression>& comparer;
+
+    bool less(const ArithmeticExpression& a,
+              const ArithmeticExpression& b) const;
+
+   public:
+    // comp is kept by reference and must outlive the selector; a temporary
+    // comparer is rejected at compile time.
+    TopKSelector(size_t k, const IComparer<ArithmeticExpression>& comp);
+    TopKSelector(size_t k, const IComparer<ArithmeticExpression>&&) = delete;
+    ~TopKSelector() = default;
+
+    TopKSelector(const TopKSelector&) = delete;
+    TopKSelector& operator=(const TopKSelector&) = delete;
+
+    // Returns false if the expression was rejected because it is not better
+    // than the current k-th element.
+    bool add(ArithmeticExpression&& expr);
+
+    size_t size() const;
+    size_t k() const;
+
+    // Moves the retained expressions out in ascending comparer order and
+    // leaves the selector empty.
+    VectorAnalog release();
+};
+
+#endif  // TOP_K_SELECTOR_H
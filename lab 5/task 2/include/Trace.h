@@ -0,0 +1,53 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Optional timeline of expression evaluation. While tracing is enabled,
+// every TraceScope records its name, start and end time, the shape it was
+// described with, the bytes it touched and its thread. Each thread writes
+// to its own ring of TRACE_RING_CAPACITY events without locking, keeping
+// the newest ones, so tracing can stay on in production. A thread that
+// exits leaves its ring to the next new one, so memory stays bounded by
+// the threads tracing at once. Disabled, a scope costs one relaxed atomic
+// load.
+//
+// writeChromeTrace() produces JSON that chrome://tracing and Perfetto
+// load directly. Call it, and clearTrace(), once the traced work has
+// finished: a ring that is still being written can only be read for the
+// events that have not been overwritten meanwhile.
+constexpr size_t TRACE_RING_CAPACITY = 16384;
+
+// Process-wide; off by default.
+void setTracingEnabled(bool enabled);
+bool isTracingEnabled();
+
+// Throws MatrixException if path cannot be written.
+void writeChromeTrace(const std::string& path);
+void clearTrace();
+
+class TraceScope {
+   private:
+    const char* name;
+    // 0 when tracing was off as the scope began.
+    uint64_t startNs;
+    size_t rows;
+    size_t cols;
+    uint64_t bytes;
+
+   public:
+    // name must outlive the trace, e.g. a string literal.
+    explicit TraceScope(const char* name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    // Shape of the matrix the scope produced and the bytes it read and
+    // wrote.
+    void describe(size_t rows, size_t cols, uint64_t bytes);
+};
+
+#endif  // TRACE_H
@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "ArithmeticExpression.h"
 #include "IComparer.h"
@@ -27,6 +29,8 @@ class VectorAnalog {
 
     void add(ArithmeticExpression&& expr);
 
+    void reserve(size_t new_capacity);
+
     void remove(size_t index);
 
     ArithmeticExpression& operator[](size_t index);
@@ -60,6 +64,31 @@ class VectorAnalog {
     void printAll() const;
 
     void sort(const IComparer<ArithmeticExpression>& comparer);
+
+    // Sorts by precomputed keys, keys[i] belonging to the i-th expression
+    // (see DiagonalProductComparer::keys). Equal keys fall back to
+    // tieBreaker if given and otherwise keep their order.
+    void sortByKeys(
+        const std::vector<double>& keys,
+        const IComparer<ArithmeticExpression>* tieBreaker = nullptr);
+
+    // Sorts only the first k positions; the rest are left in unspecified
+    // order. O(n log k) comparisons instead of O(n log n). A k past the end
+    // is clamped, as in nthElement(), so it sorts everything.
+    void partialSort(size_t k, const IComparer<ArithmeticExpression>& comparer);
+
+    // Puts the element that would be at position k after a full sort into
+    // place, with no greater elements before it and no lesser after it.
+    // A k past the end is clamped to the last position.
+    void nthElement(size_t k, const IComparer<ArithmeticExpression>& comparer);
+
+    // Writes every expression tree as a post-order node table followed by
+    // the operand matrices, so loading is a single pass with no text parsing.
+    void saveSnapshot(const std::string& path) const;
+
+    // Replaces the contents with the expressions stored by saveSnapshot().
+    // Restored expressions have no loader attached.
+    void loadSnapshot(const std::string& path);
 };
 
 #endif  // VECTOR_ANALOG_H
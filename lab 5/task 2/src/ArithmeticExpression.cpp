@@ -3,12 +3,122 @@
 #include <algorithm>
 #include <queue>
 #include <stack>
+#include <utility>
 
+#include "FixedMatrix.h"
 #include "IComparer.h"
 #include "MatrixException.h"
+#include "OverflowCheck.h"
+#include "Telemetry.h"
+#include "Trace.h"
+
+namespace {
+
+// Tiny square operands are evaluated on stack-allocated FixedMatrix values;
+// only the final result becomes a heap-backed Matrix.
+const size_t MAX_FIXED_SIZE = 4;
+
+bool allSquare(const Node* node, size_t n) {
+    if (node->isOperator()) {
+        const OperatorNode* opNode = static_cast<const OperatorNode*>(node);
+        return allSquare(opNode->getLeft(), n) &&
+               allSquare(opNode->getRight(), n);
+    }
+    const Matrix& value = static_cast<const OperandNode*>(node)->getValue();
+    return value.getRows() == n && value.getCols() == n;
+}
+
+// Decides for the whole tree rather than per subtree. The two only agree
+// because every operator needs equal shapes: in a tree that evaluates at
+// all, either every leaf is NxN or none of the subtrees would qualify.
+// Reads the tree only, so it is safe under concurrent Evaluate() calls.
+size_t fixedSquareSize(const Node* root) {
+    const Node* first = root;
+    while (first->isOperator()) {
+        first = static_cast<const OperatorNode*>(first)->getLeft();
+    }
+    size_t n = static_cast<const OperandNode*>(first)->getValue().getRows();
+    if (n < 2 || n > MAX_FIXED_SIZE) return 0;
+    return allSquare(root, n) ? n : 0;
+}
+
+// Strict mode tests every element up front. The deferred modes run the
+// unchecked kernel and verify its result, so the fixed path throws exactly
+// where Matrix would for larger operands.
+template <size_t N>
+FixedMatrix<N, N> applyFixed(char op, const FixedMatrix<N, N>& left,
+                             const FixedMatrix<N, N>& right,
+                             OverflowCheckMode mode) {
+    if (mode == OverflowCheckMode::Strict) {
+        MATRIX_COUNT(StrictOverflowChecks, 1);
+        switch (op) {
+            case '+':
+                return left + right;
+            case '-':
+                return left - right;
+            case '*':
+                return left * right;
+            case '/':
+                return left / right;
+            default:
+                throw MatrixArithmeticException("Unknown operator");
+        }
+    }
+
+    MATRIX_COUNT(DeferredOverflowChecks, 1);
+    DeferredOverflowCheck check(mode);
+    FixedMatrix<N, N> result;
+    switch (op) {
+        case '+':
+            result = left.addUnchecked(right);
+            check.finish(result.data(), N * N, "Addition overflow");
+            break;
+        case '-':
+            result = left.subtractUnchecked(right);
+            check.finish(result.data(), N * N, "Subtraction overflow");
+            break;
+        case '*':
+            result = left.multiplyUnchecked(right);
+            check.finish(result.data(), N * N, "Multiplication overflow");
+            break;
+        case '/':
+            result = left.divideUnchecked(right);
+            check.finish(result.data(), N * N, "Division overflow",
+                         right.data());
+            break;
+        default:
+            throw MatrixArithmeticException("Unknown operator");
+    }
+    return result;
+}
+
+template <size_t N>
+FixedMatrix<N, N> evaluateFixed(const Node* node, OverflowCheckMode mode) {
+    if (!node->isOperator()) {
+        return FixedMatrix<N, N>(
+            static_cast<const OperandNode*>(node)->getValue());
+    }
+
+    // Counted and traced like OperatorNode::evaluate, which this path
+    // stands in for.
+    MATRIX_COUNT(NodeEvaluations, 1);
+    const OperatorNode* opNode = static_cast<const OperatorNode*>(node);
+    TraceScope trace(opNode->getTraceName());
+    FixedMatrix<N, N> left = evaluateFixed<N>(opNode->getLeft(), mode);
+    FixedMatrix<N, N> right = evaluateFixed<N>(opNode->getRight(), mode);
+    FixedMatrix<N, N> result =
+        applyFixed<N>(opNode->getOperator(), left, right, mode);
+    trace.describe(N, N, 3 * N * N * sizeof(double));
+    return result;
+}
+
+}  // namespace
 
 ArithmeticExpression::ArithmeticExpression() : root(nullptr), loader(nullptr) {}
 
+ArithmeticExpression::ArithmeticExpression(std::unique_ptr<Node> rootNode)
+    : root(std::move(rootNode)), loader(nullptr) {}
+
 ArithmeticExpression::ArithmeticExpression(
     ArithmeticExpression&& other) noexcept
     : root(std::move(other.root)), loader(std::move(other.loader)) {}
@@ -32,7 +142,8 @@ void ArithmeticExpression::addOperand(char oper) {
     }
 
     Matrix operand = loader->GetItem();
-    std::unique_ptr<Node> newOperand = std::make_unique<OperandNode>(operand);
+    std::unique_ptr<Node> newOperand =
+        std::make_unique<OperandNode>(std::move(operand));
 
     if (!root) {
         root = std::move(newOperand);
@@ -49,39 +160,70 @@ void ArithmeticExpression::switchLoader(std::unique_ptr<Loader> newLoader) {
     loader = std::move(newLoader);
 }
 
-ArithmeticExpression::Iterator::Iterator(Node* rootNode, size_t idx)
-    : index(idx) {
+ArithmeticExpression::Iterator::Iterator() : leaf(nullptr), current(nullptr) {}
+
+ArithmeticExpression::Iterator::Iterator(const Node* rootNode)
+    : leaf(nullptr), current(nullptr) {
     if (rootNode) {
-        rootNode->collectOperands(operands);
+        descend(rootNode);
     }
 }
 
+void ArithmeticExpression::Iterator::descend(const Node* node) {
+    while (node->isOperator()) {
+        const OperatorNode* opNode = static_cast<const OperatorNode*>(node);
+        path.push_back(opNode);
+        node = opNode->getLeft();
+    }
+    leaf = node;
+    current = &static_cast<const OperandNode*>(node)->getValue();
+}
+
+bool ArithmeticExpression::Iterator::operator==(const Iterator& other) const {
+    return current == other.current;
+}
+
 bool ArithmeticExpression::Iterator::operator!=(const Iterator& other) const {
-    return index != other.index;
+    return current != other.current;
 }
 
-ArithmeticExpression& ArithmeticExpression::Iterator::operator*() const {
-    throw MatrixArithmeticException(
-        "Dereferencing Iterator is not implemented correctly.");
+const Matrix& ArithmeticExpression::Iterator::operator*() const {
+    return *current;
 }
 
-ArithmeticExpression* ArithmeticExpression::Iterator::operator->() const {
-    throw MatrixArithmeticException(
-        "Arrow Operator on Iterator is not implemented correctly.");
+const Matrix* ArithmeticExpression::Iterator::operator->() const {
+    return current;
 }
 
-const ArithmeticExpression::Iterator&
-ArithmeticExpression::Iterator::operator++() {
-    ++index;
+ArithmeticExpression::Iterator& ArithmeticExpression::Iterator::operator++() {
+    // Climb while coming up from a right child; the first left child on the
+    // way has the next leaf at the bottom of its sibling's left spine.
+    for (const Node* node = leaf; !path.empty(); path.pop_back()) {
+        const OperatorNode* parent = path.back();
+        if (parent->getLeft() == node) {
+            descend(parent->getRight());
+            return *this;
+        }
+        node = parent;
+    }
+    leaf = nullptr;
+    current = nullptr;
     return *this;
 }
 
-ArithmeticExpression::Iterator ArithmeticExpression::begin() {
-    return Iterator(root.get(), 0);
+ArithmeticExpression::Iterator ArithmeticExpression::Iterator::operator++(
+    int) {
+    Iterator previous(*this);
+    ++*this;
+    return previous;
+}
+
+ArithmeticExpression::Iterator ArithmeticExpression::begin() const {
+    return Iterator(root.get());
 }
 
-ArithmeticExpression::Iterator ArithmeticExpression::end() {
-    return Iterator(root.get(), getOperands().size());
+ArithmeticExpression::Iterator ArithmeticExpression::end() const {
+    return Iterator();
 }
 
 std::string ArithmeticExpression::PrintExpression() const {
@@ -99,10 +241,22 @@ Matrix ArithmeticExpression::Evaluate() const {
         throw MatrixArithmeticException("Expression tree is empty");
     }
 
+    OverflowCheckMode mode = getOverflowCheckMode();
+    switch (fixedSquareSize(root.get())) {
+        case 2:
+            return evaluateFixed<2>(root.get(), mode).toMatrix();
+        case 3:
+            return evaluateFixed<3>(root.get(), mode).toMatrix();
+        case 4:
+            return evaluateFixed<4>(root.get(), mode).toMatrix();
+        default:
+            break;
+    }
+
     std::unique_ptr<Node> evaluated = root->evaluate();
     OperandNode* resultNode = dynamic_cast<OperandNode*>(evaluated.get());
     if (resultNode) {
-        return resultNode->getValue();
+        return std::move(resultNode->getValue());
     } else {
         throw MatrixArithmeticException(
             "Evaluation did not result in an operand");
@@ -166,7 +320,8 @@ bool ArithmeticExpression::StepEvaluate() {
                             "Unknown operator during step evaluation");
                 }
 
-                replaceNode(node, std::make_unique<OperandNode>(result));
+                replaceNode(node,
+                            std::make_unique<OperandNode>(std::move(result)));
 
                 return true;
             }
@@ -220,3 +375,5 @@ std::vector<Matrix*> ArithmeticExpression::getOperands() const {
     return operandsVec;
 }
 
+
+const Node* ArithmeticExpression::getRoot() const { return root.get(); }
@@ -0,0 +1,86 @@
+#include "AsyncLoader.h"
+#include "MatrixException.h"
+#include <algorithm>
+#include <utility>
+
+AsyncLoader::AsyncLoader(std::unique_ptr<Loader> source, size_t capacity)
+    : source(std::move(source)), slots(std::max<size_t>(1, capacity)) {
+    if (!this->source) {
+        throw MatrixException("AsyncLoader needs a loader to wrap");
+    }
+    if (!this->source->CanReadAhead()) {
+        throw MatrixException(
+            "AsyncLoader cannot read ahead from an endless or interactive "
+            "loader");
+    }
+    reader = std::thread(&AsyncLoader::readAhead, this);
+}
+
+AsyncLoader::~AsyncLoader() {
+    stopping.store(true, std::memory_order_release);
+    // Dropping everything buffered frees a reader blocked on a full ring:
+    // the head it waits on changes.
+    head.store(tail.load(std::memory_order_acquire),
+               std::memory_order_release);
+    head.notify_one();
+    reader.join();
+}
+
+void AsyncLoader::readAhead() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        Slot slot;
+        try {
+            if (source->HasNext()) {
+                slot.value = source->GetItem();
+            } else {
+                slot.end = true;
+            }
+        } catch (...) {
+            slot.error = std::current_exception();
+        }
+        bool last = slot.end || slot.error;
+        if (!publish(std::move(slot)) || last) return;
+    }
+}
+
+bool AsyncLoader::publish(Slot&& slot) {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    uint64_t h = head.load(std::memory_order_acquire);
+    while (t - h == slots.size()) {
+        if (stopping.load(std::memory_order_acquire)) return false;
+        head.wait(h, std::memory_order_acquire);
+        h = head.load(std::memory_order_acquire);
+    }
+    slots[t % slots.size()] = std::move(slot);
+    tail.store(t + 1, std::memory_order_release);
+    tail.notify_one();
+    return true;
+}
+
+const AsyncLoader::Slot& AsyncLoader::front() {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    uint64_t t = tail.load(std::memory_order_acquire);
+    while (t == h) {
+        tail.wait(t, std::memory_order_acquire);
+        t = tail.load(std::memory_order_acquire);
+    }
+    return slots[h % slots.size()];
+}
+
+Matrix AsyncLoader::GetItem() {
+    const Slot& slot = front();
+    if (slot.error) std::rethrow_exception(slot.error);
+    if (slot.end) {
+        throw MatrixException("AsyncLoader has no more items");
+    }
+
+    uint64_t h = head.load(std::memory_order_relaxed);
+    Matrix item = std::move(slots[h % slots.size()].value);
+    head.store(h + 1, std::memory_order_release);
+    head.notify_one();
+    return item;
+}
+
+bool AsyncLoader::HasNext() { return !front().end; }
+
+bool AsyncLoader::CanReadAhead() const { return true; }
@@ -1,6 +1,11 @@
 #include "Comparers/DiagonalProductComparer.h"
 
 #include "Helpers.h"
+#include "ParallelFor.h"
+
+// Evaluating an expression dominates, so even small batches are worth
+// splitting.
+static const size_t MIN_EXPRESSIONS_PER_THREAD = 8;
 
 int DiagonalProductComparer::Compare(const ArithmeticExpression& o1,
                                      const ArithmeticExpression& o2) const {
@@ -14,3 +19,17 @@ int DiagonalProductComparer::Compare(const ArithmeticExpression& o1,
     if (product1 > product2) return 1;
     return 0;
 }
+
+std::vector<double> DiagonalProductComparer::keys(
+    const VectorAnalog& expressions, size_t threadCount) {
+    // Each result is reduced to its key as soon as it is evaluated, so only
+    // one matrix per thread is alive at a time.
+    std::vector<double> products(expressions.size());
+    parallelFor(expressions.size(), threadCount, MIN_EXPRESSIONS_PER_THREAD,
+                [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            products[i] = calculateDiagonalProduct(expressions[i].Evaluate());
+        }
+    });
+    return products;
+}
@@ -0,0 +1,128 @@
+#include "ConcurrentVectorAnalog.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "MatrixException.h"
+
+ConcurrentVectorAnalog::ConcurrentVectorAnalog() : size_(0) {
+    for (size_t s = 0; s < MAX_SEGMENTS; ++s) {
+        segments[s].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ConcurrentVectorAnalog::~ConcurrentVectorAnalog() { clear(); }
+
+size_t ConcurrentVectorAnalog::segmentOf(size_t index) {
+    size_t bucket = index / FIRST_SEGMENT_SIZE + 1;
+    size_t segment = 0;
+    while (bucket >>= 1) {
+        segment++;
+    }
+    return segment;
+}
+
+size_t ConcurrentVectorAnalog::segmentStart(size_t segment) {
+    return FIRST_SEGMENT_SIZE * ((size_t(1) << segment) - 1);
+}
+
+size_t ConcurrentVectorAnalog::segmentSize(size_t segment) {
+    return FIRST_SEGMENT_SIZE << segment;
+}
+
+ArithmeticExpression* ConcurrentVectorAnalog::ensureSegment(size_t segment) {
+    ArithmeticExpression* current =
+        segments[segment].load(std::memory_order_acquire);
+    if (current) {
+        return current;
+    }
+
+    ArithmeticExpression* fresh;
+    try {
+        fresh = new ArithmeticExpression[segmentSize(segment)];
+    } catch (const std::bad_alloc&) {
+        throw MatrixException(
+            "Memory allocation failed in ConcurrentVectorAnalog::add");
+    }
+
+    if (segments[segment].compare_exchange_strong(current, fresh,
+                                                  std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)) {
+        return fresh;
+    }
+    // Another producer installed the segment first.
+    delete[] fresh;
+    return current;
+}
+
+void ConcurrentVectorAnalog::clear() {
+    for (size_t s = 0; s < MAX_SEGMENTS; ++s) {
+        delete[] segments[s].exchange(nullptr, std::memory_order_acq_rel);
+    }
+    size_.store(0, std::memory_order_relaxed);
+}
+
+size_t ConcurrentVectorAnalog::add(ArithmeticExpression&& expr) {
+    // The slot is claimed only once its segment exists, so a failed add
+    // (capacity or allocation) leaves size_ untouched and every counted slot
+    // backed by storage. Nothing after the claim can throw.
+    size_t index = size_.load(std::memory_order_relaxed);
+    for (;;) {
+        size_t segment = segmentOf(index);
+        if (segment >= MAX_SEGMENTS) {
+            throw MatrixException("ConcurrentVectorAnalog capacity exceeded");
+        }
+        ArithmeticExpression* items = ensureSegment(segment);
+        if (size_.compare_exchange_weak(index, index + 1,
+                                        std::memory_order_relaxed)) {
+            items[index - segmentStart(segment)] = std::move(expr);
+            return index;
+        }
+    }
+}
+
+ArithmeticExpression& ConcurrentVectorAnalog::operator[](size_t index) {
+    if (index >= size()) {
+        throw MatrixException(
+            "Index out of bounds in ConcurrentVectorAnalog::operator[]");
+    }
+    size_t segment = segmentOf(index);
+    return segments[segment].load(std::memory_order_acquire)
+        [index - segmentStart(segment)];
+}
+
+const ArithmeticExpression& ConcurrentVectorAnalog::operator[](
+    size_t index) const {
+    if (index >= size()) {
+        throw MatrixException(
+            "Index out of bounds in ConcurrentVectorAnalog::operator[]");
+    }
+    size_t segment = segmentOf(index);
+    return segments[segment].load(std::memory_order_acquire)
+        [index - segmentStart(segment)];
+}
+
+size_t ConcurrentVectorAnalog::size() const {
+    return size_.load(std::memory_order_acquire);
+}
+
+VectorAnalog ConcurrentVectorAnalog::freeze() {
+    size_t count = size();
+    VectorAnalog result;
+    result.reserve(count);
+
+    for (size_t s = 0; s < MAX_SEGMENTS && segmentStart(s) < count; ++s) {
+        ArithmeticExpression* items =
+            segments[s].load(std::memory_order_acquire);
+        if (!items) {
+            continue;
+        }
+        size_t end = std::min(count - segmentStart(s), segmentSize(s));
+        for (size_t i = 0; i < end; ++i) {
+            result.add(std::move(items[i]));
+        }
+    }
+
+    clear();
+    return result;
+}
@@ -1,26 +1,60 @@
 #include "Helpers.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <type_traits>
 
-double calculateDiagonalProduct(const Matrix& matrix) {
+#include "ElementOps.h"
+#include "ParallelFor.h"
+
+// A diagonal product is an O(n) walk, so threads only pay off for fairly
+// large batches.
+static const size_t MIN_MATRICES_PER_THREAD = 64;
+
+// Floating-point results keep their old unchecked behaviour; integer ones
+// must not wrap.
+template <typename T>
+static T multiplyChecked(T a, T b) {
+    if constexpr (std::is_integral<T>::value) {
+        T result;
+        if (!ElementOps<T>::multiply(a, b, result)) {
+            throw MatrixOverflowException("Diagonal product overflow");
+        }
+        return result;
+    } else {
+        return a * b;
+    }
+}
+
+template <typename T>
+static void accumulateChecked(T& sum, T value) {
+    if (!ElementOps<T>::accumulate(sum, value)) {
+        throw MatrixOverflowException("Diagonal product overflow");
+    }
+}
+
+// Shared by the matrix and view overloads; M is BasicMatrix<T> or
+// BasicMatrixView<T>.
+template <typename T, typename M>
+static T diagonalSumsProduct(const M& matrix) {
     size_t rows = matrix.getRows();
-    size_t cols = matrix.getCols();
-    if (rows != cols) {
+    if (rows != matrix.getCols()) {
         throw MatrixArithmeticException(
             "Matrix is not square for diagonal product calculation");
     }
 
-    double mainDiagonalSum = 0.0;
-    double secondaryDiagonalSum = 0.0;
+    T mainDiagonalSum = T();
+    T secondaryDiagonalSum = T();
     for (size_t i = 0; i < rows; ++i) {
-        mainDiagonalSum += matrix(i, i);
-        secondaryDiagonalSum += matrix(i, rows - i - 1);
+        accumulateChecked(mainDiagonalSum, matrix(i, i));
+        accumulateChecked(secondaryDiagonalSum, matrix(i, rows - i - 1));
     }
 
-    return mainDiagonalSum * secondaryDiagonalSum;
+    return multiplyChecked(mainDiagonalSum, secondaryDiagonalSum);
 }
 
-int compareMatricesLex(const Matrix& m1, const Matrix& m2) {
+template <typename M>
+static int compareLex(const M& m1, const M& m2) {
     size_t minRows = std::min(m1.getRows(), m2.getRows());
     size_t minCols = std::min(m1.getCols(), m2.getCols());
 
@@ -38,3 +72,98 @@ int compareMatricesLex(const Matrix& m1, const Matrix& m2) {
 
     return 0;
 }
+
+template <typename T>
+T calculateDiagonalProduct(const BasicMatrix<T>& matrix) {
+    size_t rows = matrix.getRows();
+    size_t cols = matrix.getCols();
+    if (rows != cols) {
+        throw MatrixArithmeticException(
+            "Matrix is not square for diagonal product calculation");
+    }
+
+    // For c * I the main diagonal sums to n * c and the anti-diagonal only
+    // crosses the main one (at the centre) when n is odd.
+    switch (matrix.getStructure()) {
+        case MatrixStructure::Identity:
+            return rows % 2 == 1 ? static_cast<T>(rows) : T();
+        case MatrixStructure::Scalar: {
+            if (rows % 2 == 0) return T();
+            T c = matrix(0, 0);
+            return multiplyChecked(multiplyChecked(static_cast<T>(rows), c),
+                                   c);
+        }
+        case MatrixStructure::Diagonal:
+            if (rows % 2 == 0) return T();
+            break;
+        default:
+            break;
+    }
+
+    // A cached summary already holds the product, summed in the same order
+    // as diagonalSumsProduct. Otherwise only the two diagonals are read:
+    // O(n), where filling a summary would cost O(n^2) for matrices that
+    // are usually fresh evaluation results.
+    if (matrix.hasSummary()) {
+        const MatrixSummary<T>& summary = matrix.summary();
+        if (summary.diagonalProductOverflowed) {
+            throw MatrixOverflowException("Diagonal product overflow");
+        }
+        return summary.diagonalProduct;
+    }
+    return diagonalSumsProduct<T>(matrix);
+}
+
+template <typename T>
+int compareMatricesLex(const BasicMatrix<T>& m1, const BasicMatrix<T>& m2) {
+    return compareLex(m1, m2);
+}
+
+template <typename T>
+std::vector<T> calculateDiagonalProducts(
+    std::span<const BasicMatrix<T>> matrices, size_t threadCount) {
+    std::vector<T> products(matrices.size());
+    parallelFor(matrices.size(), threadCount, MIN_MATRICES_PER_THREAD,
+                [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            products[k] = calculateDiagonalProduct(matrices[k]);
+        }
+    });
+    return products;
+}
+
+template <typename T>
+T calculateDiagonalProduct(const BasicMatrixView<T>& view) {
+    return diagonalSumsProduct<T>(view);
+}
+
+template <typename T>
+int compareMatricesLex(const BasicMatrixView<T>& m1,
+                       const BasicMatrixView<T>& m2) {
+    return compareLex(m1, m2);
+}
+
+template float calculateDiagonalProduct(const FloatMatrix&);
+template double calculateDiagonalProduct(const Matrix&);
+template int64_t calculateDiagonalProduct(const Int64Matrix&);
+
+template int compareMatricesLex(const FloatMatrix&, const FloatMatrix&);
+template int compareMatricesLex(const Matrix&, const Matrix&);
+template int compareMatricesLex(const Int64Matrix&, const Int64Matrix&);
+
+template std::vector<float> calculateDiagonalProducts(
+    std::span<const FloatMatrix>, size_t);
+template std::vector<double> calculateDiagonalProducts(std::span<const Matrix>,
+                                                       size_t);
+template std::vector<int64_t> calculateDiagonalProducts(
+    std::span<const Int64Matrix>, size_t);
+
+template float calculateDiagonalProduct(const FloatMatrixView&);
+template double calculateDiagonalProduct(const MatrixView&);
+template int64_t calculateDiagonalProduct(const Int64MatrixView&);
+
+template int compareMatricesLex(const FloatMatrixView&,
+                                const FloatMatrixView&);
+template int compareMatricesLex(const MatrixView&, const MatrixView&);
+template int compareMatricesLex(const Int64MatrixView&,
+                                const Int64MatrixView&);
@@ -1,18 +1,26 @@
 #include "Loader.h"
 #include "MatrixException.h"
+#include "Telemetry.h"
+#include "Trace.h"
 #include <iostream>
 #include <fstream>
 
 Matrix ConsoleLoader::GetItem() {
+    TraceScope trace("ConsoleLoader::GetItem");
     std::cout << "Enter matrix in format [a,b;c,d]: ";
     std::string input;
     std::cin >> input;
-    return Matrix(input.c_str());
+    MATRIX_COUNT(LoaderItems, 1);
+    MATRIX_COUNT(LoaderBytes, input.size());
+    Matrix item(input.c_str());
+    trace.describe(item.getRows(), item.getCols(), input.size());
+    return item;
 }
 
 FileLoader::FileLoader(const std::string& fname) : filename(fname) {}
 
 Matrix FileLoader::GetItem() {
+    TraceScope trace("FileLoader::GetItem");
     std::ifstream infile(filename);
     if (!infile.is_open()) {
         throw MatrixException("Unable to open file: " + filename);
@@ -22,5 +30,9 @@ Matrix FileLoader::GetItem() {
     std::getline(infile, input);
     infile.close();
 
-    return Matrix(input.c_str());
+    MATRIX_COUNT(LoaderItems, 1);
+    MATRIX_COUNT(LoaderBytes, input.size());
+    Matrix item(input.c_str());
+    trace.describe(item.getRows(), item.getCols(), input.size());
+    return item;
 }
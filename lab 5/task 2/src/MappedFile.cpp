@@ -0,0 +1,87 @@
+#include "MappedFile.h"
+
+#include <fstream>
+
+#include "MatrixException.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path, Access access)
+    : data_(nullptr), size_(0) {
+#ifdef MAPPED_FILE_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw MatrixException("Unable to open file: " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw MatrixException("Unable to stat file: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ > 0) {
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw MatrixException("Unable to map file: " + path);
+        }
+        ::madvise(mapped, size_,
+                  access == Access::Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapped);
+    }
+    ::close(fd);
+#else
+    (void)access;
+    std::ifstream infile(path, std::ios::binary | std::ios::ate);
+    if (!infile.is_open()) {
+        throw MatrixException("Unable to open file: " + path);
+    }
+    size_ = static_cast<size_t>(infile.tellg());
+    buffer = std::make_unique<char[]>(size_);
+    infile.seekg(0);
+    infile.read(buffer.get(), size_);
+    data_ = buffer.get();
+#endif
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_), size_(other.size_), buffer(std::move(other.buffer)) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = other.data_;
+        size_ = other.size_;
+        buffer = std::move(other.buffer);
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedFile::unmap() {
+#ifdef MAPPED_FILE_USE_MMAP
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+const char* MappedFile::data() const { return data_; }
+
+size_t MappedFile::size() const { return size_; }
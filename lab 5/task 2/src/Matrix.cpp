@@ -1,80 +1,591 @@
 #include "Matrix.h"
 
-#include <cfloat>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <list>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
-void Matrix::allocateMemory() {
-    try {
-        data = new double*[rows];
-        for (size_t i = 0; i < rows; ++i) {
-            data[i] = new double[cols];
+#include "CheckedArithmetic.h"
+#include "ElementOps.h"
+#include "MatrixAllocator.h"
+#include "MatrixView.h"
+#include "OverflowCheck.h"
+#include "Strassen.h"
+#include "Telemetry.h"
+
+// Large operands with at most SPARSE_ENTER_DENSITY non-zeros are kept in CSR
+// form; they return to dense storage once they fill in past
+// SPARSE_LEAVE_DENSITY. The gap keeps a matrix near the threshold from
+// flipping format on every operation.
+const size_t SPARSE_MIN_ELEMENTS = 256;
+const double SPARSE_ENTER_DENSITY = 0.1;
+const double SPARSE_LEAVE_DENSITY = 0.25;
+
+// Each thread keeps the LITERAL_CACHE_CAPACITY most recently used string
+// operands of the const char* operators in parsed form. Strings longer than
+// LITERAL_CACHE_MAX_LENGTH are parsed every time, which bounds the memory a
+// cache can hold.
+const size_t LITERAL_CACHE_CAPACITY = 64;
+const size_t LITERAL_CACHE_MAX_LENGTH = 4096;
+
+static bool isScalarKind(MatrixStructure s) {
+    return s == MatrixStructure::Identity || s == MatrixStructure::Scalar;
+}
+
+static bool isDiagonalKind(MatrixStructure s) {
+    return s == MatrixStructure::Diagonal || isScalarKind(s);
+}
+
+static bool isUpperKind(MatrixStructure s) {
+    return s == MatrixStructure::UpperTriangular || isDiagonalKind(s);
+}
+
+static bool isLowerKind(MatrixStructure s) {
+    return s == MatrixStructure::LowerTriangular || isDiagonalKind(s);
+}
+
+// Structure kept by a sum, difference or product of the two operands: zeros
+// that both sides share in the same triangle stay exactly zero.
+static MatrixStructure combineStructure(MatrixStructure a, MatrixStructure b) {
+    if (isScalarKind(a) && isScalarKind(b)) return MatrixStructure::Scalar;
+    if (isDiagonalKind(a) && isDiagonalKind(b)) {
+        return MatrixStructure::Diagonal;
+    }
+    if (isUpperKind(a) && isUpperKind(b)) {
+        return MatrixStructure::UpperTriangular;
+    }
+    if (isLowerKind(a) && isLowerKind(b)) {
+        return MatrixStructure::LowerTriangular;
+    }
+    return MatrixStructure::General;
+}
+
+// Element-wise division keeps the dividend's zeros but not its diagonal
+// values.
+static MatrixStructure divisionStructure(MatrixStructure a) {
+    return isDiagonalKind(a) ? MatrixStructure::Diagonal : a;
+}
+
+// In a deferred OverflowCheckMode, runs kernel() without per-element checks
+// and verifies out[0..count) afterwards. Returns false in Strict mode, and
+// always for integers, so the caller runs its checked loop instead.
+template <typename T, typename Kernel>
+static bool runDeferred(Kernel kernel, const T* out, size_t count,
+                        const char* message, const T* divisors = nullptr) {
+    if constexpr (std::is_floating_point<T>::value) {
+        if (getOverflowCheckMode() != OverflowCheckMode::Strict) {
+            MATRIX_COUNT(DeferredOverflowChecks, 1);
+            DeferredOverflowCheck check;
+            kernel();
+            check.finish(out, count, message, divisors);
+            return true;
         }
+    }
+    MATRIX_COUNT(StrictOverflowChecks, 1);
+    return false;
+}
+
+template <typename T>
+static T maxAbsolute(const T* values, size_t count) {
+    T largest = T();
+    for (size_t k = 0; k < count; ++k) {
+        largest = std::max(largest, std::abs(values[k]));
+    }
+    return largest;
+}
+
+// Large floating-point products go through Strassen-Winograd. The
+// deferred modes verify its result afterwards. Strict mode cannot check
+// the terms inside the recursion, so it bounds them up front: when
+// max|a| * max|b| * strassenGrowthBound(n) is finite, no intermediate can
+// overflow and no term of the classical kernel would have thrown either.
+// Otherwise, or with an infinity or NaN in an operand, the checked
+// classical kernel runs and reports the overflow as before.
+template <typename T>
+static bool multiplyStrassen(const T* a, const T* b, T* out, size_t n) {
+    if constexpr (std::is_floating_point<T>::value) {
+        if (n < STRASSEN_MIN_SIZE) return false;
+        OverflowCheckMode mode = getOverflowCheckMode();
+        if (mode != OverflowCheckMode::Strict) {
+            DeferredOverflowCheck check(mode);
+            MATRIX_COUNT(DeferredOverflowChecks, 1);
+            strassenMultiply(a, b, out, n);
+            check.finish(out, n * n, "Multiplication overflow");
+            return true;
+        }
+
+        double bound = static_cast<double>(maxAbsolute(a, n * n)) *
+                       static_cast<double>(maxAbsolute(b, n * n)) *
+                       strassenGrowthBound(n);
+        if (!(bound <= std::numeric_limits<T>::max())) return false;
+        MATRIX_COUNT(StrictOverflowChecks, 1);
+        strassenMultiply(a, b, out, n);
+        if (findNonFinite(out, n * n) != n * n) {
+            throw MatrixOverflowException("Multiplication overflow");
+        }
+        return true;
+    }
+    return false;
+}
+
+template <typename T>
+void BasicMatrix<T>::allocateMemory() {
+    if (rows * cols <= INLINE_CAPACITY) {
+        elements = inlineStorage;
+        return;
+    }
+    allocator = getMatrixAllocator();
+    MATRIX_COUNT(MatrixAllocations, 1);
+    MATRIX_COUNT(MatrixBytes, rows * cols * sizeof(T));
+    try {
+        elements =
+            static_cast<T*>(allocator->allocate(rows * cols * sizeof(T)));
     } catch (const std::bad_alloc&) {
         throw MatrixException(
             "Memory allocation failed during matrix initialization");
     }
 }
 
-void Matrix::deallocateMemory() {
-    if (data) {
+template <typename T>
+void BasicMatrix<T>::deallocateMemory() {
+    if (elements && elements != inlineStorage) {
+        allocator->deallocate(elements, rows * cols * sizeof(T));
+    }
+}
+
+template <typename T>
+void BasicMatrix<T>::copyData(const BasicMatrix& other) {
+    std::memcpy(elements, other.elements, rows * cols * sizeof(T));
+}
+
+template <typename T>
+void BasicMatrix<T>::takeData(BasicMatrix& other) {
+    if (other.elements == other.inlineStorage) {
+        std::memcpy(inlineStorage, other.inlineStorage,
+                    other.rows * other.cols * sizeof(T));
+        elements = inlineStorage;
+    } else {
+        elements = other.elements;
+        allocator = other.allocator;
+    }
+    other.elements = nullptr;
+}
+
+template <typename T>
+T BasicMatrix<T>::sum() const {
+    const MatrixSummary<T>& cached = summary();
+    if (cached.sumOverflowed) {
+        throw MatrixOverflowException("Sum overflow");
+    }
+    return cached.sum;
+}
+
+static size_t combineHash(size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+template <typename T>
+void BasicMatrix<T>::computeSummary() const {
+    MatrixSummary<T> result{};
+    result.hash = combineHash(rows, cols);
+    bool first = true;
+
+    // Elements arrive in row-major order with their flat index, from
+    // either format.
+    auto visit = [&](size_t position, T value) {
+        if (first) {
+            result.min = value;
+            result.max = value;
+            first = false;
+        }
+        if (!result.sumOverflowed &&
+            !ElementOps<T>::accumulate(result.sum, value)) {
+            result.sumOverflowed = true;
+        }
+        result.min = std::min(result.min, value);
+        result.max = std::max(result.max, value);
+        if (value != T()) {
+            result.hash = combineHash(result.hash, position);
+            result.hash = combineHash(result.hash, std::hash<T>()(value));
+        }
+    };
+
+    if (sparse) {
         for (size_t i = 0; i < rows; ++i) {
-            delete[] data[i];
+            for (size_t p = sparse->rowPtr[i]; p < sparse->rowPtr[i + 1];
+                 ++p) {
+                visit(i * cols + sparse->colIndex[p], sparse->values[p]);
+            }
+        }
+        // The implicit zeros take part in min and max.
+        if (sparse->nonZeros() < rows * cols) visit(0, T());
+    } else {
+        for (size_t k = 0; k < rows * cols; ++k) visit(k, elements[k]);
+    }
+
+    for (size_t i = 0; i < std::min(rows, cols); ++i) {
+        if (!ElementOps<T>::accumulate(result.trace, valueAt(i, i)) ||
+            !ElementOps<T>::accumulate(result.antiTrace,
+                                       valueAt(i, cols - 1 - i))) {
+            result.diagonalsOverflowed = true;
+            break;
+        }
+    }
+    if constexpr (std::is_integral<T>::value) {
+        result.diagonalProductOverflowed =
+            result.diagonalsOverflowed ||
+            !ElementOps<T>::multiply(result.trace, result.antiTrace,
+                                     result.diagonalProduct);
+    } else {
+        result.diagonalProduct = result.trace * result.antiTrace;
+    }
+
+    summaryCache = result;
+    summaryValid = true;
+}
+
+template <typename T>
+const MatrixSummary<T>& BasicMatrix<T>::summary() const {
+    if (!summaryValid) computeSummary();
+    return summaryCache;
+}
+
+template <typename T>
+T BasicMatrix<T>::valueAt(size_t row, size_t col) const {
+    if (sparse) {
+        const T* value = sparse->find(row, col);
+        return value ? *value : T();
+    }
+    return elements[row * cols + col];
+}
+
+template <typename T>
+void BasicMatrix<T>::detectStructure() {
+    structure = MatrixStructure::General;
+    if (rows != cols || rows == 0) return;
+
+    bool upper = true;
+    bool lower = true;
+    if (sparse) {
+        for (size_t i = 0; i < rows && (upper || lower); ++i) {
+            for (size_t p = sparse->rowPtr[i]; p < sparse->rowPtr[i + 1];
+                 ++p) {
+                if (sparse->colIndex[p] < i) upper = false;
+                if (sparse->colIndex[p] > i) lower = false;
+            }
+        }
+    } else {
+        // Exits as soon as both triangles hold a non-zero, which for a
+        // general matrix is usually within the first two rows.
+        for (size_t i = 0; i < rows && (upper || lower); ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                if (elements[i * cols + j] == T()) continue;
+                if (j < i) upper = false;
+                if (j > i) lower = false;
+            }
+        }
+    }
+
+    if (upper && lower) {
+        T first = valueAt(0, 0);
+        bool uniform = true;
+        for (size_t i = 1; i < rows && uniform; ++i) {
+            uniform = valueAt(i, i) == first;
+        }
+        if (!uniform) {
+            structure = MatrixStructure::Diagonal;
+        } else {
+            structure = first == T(1) ? MatrixStructure::Identity
+                                      : MatrixStructure::Scalar;
         }
-        delete[] data;
+    } else if (upper) {
+        structure = MatrixStructure::UpperTriangular;
+    } else if (lower) {
+        structure = MatrixStructure::LowerTriangular;
     }
 }
 
-void Matrix::copyData(const Matrix& other) {
+template <typename T>
+void BasicMatrix<T>::finishResult(MatrixStructure kind) {
+    if (kind == MatrixStructure::Scalar && rows > 0 && valueAt(0, 0) == T(1)) {
+        kind = MatrixStructure::Identity;
+    }
+    structure = kind;
+    selectFormat();
+}
+
+template <typename T>
+void BasicMatrix<T>::selectFormat() {
+    size_t total = rows * cols;
+    if (total < SPARSE_MIN_ELEMENTS) {
+        if (sparse) toDense();
+        return;
+    }
+
+    if (sparse) {
+        if (sparse->nonZeros() > SPARSE_LEAVE_DENSITY * total) toDense();
+        return;
+    }
+
+    size_t limit = static_cast<size_t>(SPARSE_ENTER_DENSITY * total);
+    size_t nonZeroCount = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            if (elements[i * cols + j] != T()) nonZeroCount++;
+        }
+        if (nonZeroCount > limit) return;
+    }
+    toSparse();
+}
+
+template <typename T>
+void BasicMatrix<T>::toSparse() {
+    auto storage = std::make_unique<SparseStorage<T>>(rows);
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
-            data[i][j] = other.data[i][j];
+            storage->append(j, elements[i * cols + j]);
+        }
+        storage->endRow();
+    }
+    deallocateMemory();
+    elements = nullptr;
+    sparse = std::move(storage);
+}
+
+template <typename T>
+void BasicMatrix<T>::toDense() {
+    if (!sparse) return;
+
+    allocateMemory();
+    std::fill(elements, elements + rows * cols, T());
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t p = sparse->rowPtr[i]; p < sparse->rowPtr[i + 1]; ++p) {
+            elements[i * cols + sparse->colIndex[p]] = sparse->values[p];
         }
     }
+    sparse.reset();
 }
 
-double Matrix::sum() const {
-    double result = 0;
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::addSparse(const BasicMatrix& other,
+                                         bool subtract) const {
+    if (sparse && other.sparse) {
+        BasicMatrix result;
+        result.rows = rows;
+        result.cols = cols;
+        result.sparse = std::make_unique<SparseStorage<T>>(rows);
+        SparseStorage<T>& out = *result.sparse;
+        const SparseStorage<T>& a = *sparse;
+        const SparseStorage<T>& b = *other.sparse;
+
+        for (size_t i = 0; i < rows; ++i) {
+            size_t p = a.rowPtr[i];
+            size_t q = b.rowPtr[i];
+            while (p < a.rowPtr[i + 1] || q < b.rowPtr[i + 1]) {
+                size_t colA = p < a.rowPtr[i + 1] ? a.colIndex[p] : SIZE_MAX;
+                size_t colB = q < b.rowPtr[i + 1] ? b.colIndex[q] : SIZE_MAX;
+                if (colA < colB) {
+                    out.append(colA, a.values[p++]);
+                } else if (colB < colA) {
+                    out.append(colB, addOrThrow(T(), b.values[q++], subtract));
+                } else {
+                    out.append(colA, addOrThrow(a.values[p++], b.values[q++],
+                                                subtract));
+                }
+            }
+            out.endRow();
+        }
+        return result;
+    }
+
+    // One side is dense: walk it in full and pick up the sparse side's
+    // non-zeros along the way.
+    const BasicMatrix& sparseSide = sparse ? *this : other;
+    const SparseStorage<T>& s = *sparseSide.sparse;
+    const T* dense = sparse ? other.elements : elements;
+
+    BasicMatrix result(rows, cols);
     for (size_t i = 0; i < rows; ++i) {
+        size_t p = s.rowPtr[i];
         for (size_t j = 0; j < cols; ++j) {
-            result += data[i][j];
+            T stored = T();
+            if (p < s.rowPtr[i + 1] && s.colIndex[p] == j) {
+                stored = s.values[p++];
+            }
+            T d = dense[i * cols + j];
+            result.elements[i * cols + j] =
+                sparse ? addOrThrow(stored, d, subtract)
+                       : addOrThrow(d, stored, subtract);
         }
     }
     return result;
 }
 
-bool Matrix::willOverflow(double a, double b) const {
-    return (b > 0 && a > DBL_MAX - b) || (b < 0 && a < -DBL_MAX - b);
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::multiplySparse(const BasicMatrix& other) const {
+    if (sparse && other.sparse) {
+        // Gustavson's row-by-row product with a dense accumulator row.
+        const SparseStorage<T>& a = *sparse;
+        const SparseStorage<T>& b = *other.sparse;
+        std::vector<T> accumulator(other.cols, T());
+        std::vector<size_t> marker(other.cols, SIZE_MAX);
+        std::vector<size_t> touched;
+
+        BasicMatrix result;
+        result.rows = rows;
+        result.cols = other.cols;
+        result.sparse = std::make_unique<SparseStorage<T>>(rows);
+
+        for (size_t i = 0; i < rows; ++i) {
+            touched.clear();
+            for (size_t p = a.rowPtr[i]; p < a.rowPtr[i + 1]; ++p) {
+                size_t k = a.colIndex[p];
+                for (size_t q = b.rowPtr[k]; q < b.rowPtr[k + 1]; ++q) {
+                    size_t j = b.colIndex[q];
+                    if (marker[j] != i) {
+                        marker[j] = i;
+                        accumulator[j] = T();
+                        touched.push_back(j);
+                    }
+                    multiplyAddOrThrow(accumulator[j], a.values[p],
+                                       b.values[q]);
+                }
+            }
+            std::sort(touched.begin(), touched.end());
+            for (size_t j : touched) {
+                result.sparse->append(j, accumulator[j]);
+            }
+            result.sparse->endRow();
+        }
+        return result;
+    }
+
+    BasicMatrix result(rows, other.cols);
+    if (sparse) {
+        // Each non-zero a(i,k) adds a scaled row k of the dense operand.
+        for (size_t i = 0; i < rows; ++i) {
+            T* rowC = result.elements + i * other.cols;
+            for (size_t p = sparse->rowPtr[i]; p < sparse->rowPtr[i + 1];
+                 ++p) {
+                T a = sparse->values[p];
+                const T* rowB =
+                    other.elements + sparse->colIndex[p] * other.cols;
+                for (size_t j = 0; j < other.cols; ++j) {
+                    multiplyAddOrThrow(rowC[j], a, rowB[j]);
+                }
+            }
+        }
+    } else {
+        const SparseStorage<T>& b = *other.sparse;
+        for (size_t i = 0; i < rows; ++i) {
+            T* rowC = result.elements + i * other.cols;
+            for (size_t k = 0; k < cols; ++k) {
+                T a = elements[i * cols + k];
+                if (a == T()) continue;
+                for (size_t q = b.rowPtr[k]; q < b.rowPtr[k + 1]; ++q) {
+                    multiplyAddOrThrow(rowC[b.colIndex[q]], a, b.values[q]);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::divideSparse(const BasicMatrix& other) const {
+    // A sparse divisor always holds at least one zero element.
+    if (other.sparse && other.sparse->nonZeros() < rows * cols) {
+        throw MatrixDivisionByZeroException(
+            "Division by zero in matrix element");
+    }
+
+    for (size_t k = 0; k < rows * cols; ++k) {
+        if (ElementOps<T>::isZeroDivisor(other.elements[k])) {
+            throw MatrixDivisionByZeroException(
+                "Division by zero in matrix element");
+        }
+    }
+
+    // 0 / x is 0, so the quotient keeps the dividend's sparsity pattern.
+    BasicMatrix result;
+    result.rows = rows;
+    result.cols = cols;
+    result.sparse = std::make_unique<SparseStorage<T>>(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t p = sparse->rowPtr[i]; p < sparse->rowPtr[i + 1]; ++p) {
+            size_t j = sparse->colIndex[p];
+            result.sparse->append(
+                j, divideOrThrow(sparse->values[p],
+                                 other.elements[i * cols + j]));
+        }
+        result.sparse->endRow();
+    }
+    return result;
 }
 
-Matrix::Matrix() : data(nullptr), rows(0), cols(0) {}
+template <typename T>
+BasicMatrix<T>::BasicMatrix()
+    : elements(nullptr),
+      rows(0),
+      cols(0),
+      structure(MatrixStructure::General) {}
 
-Matrix::Matrix(size_t r, size_t c) : rows(r), cols(c) {
+template <typename T>
+BasicMatrix<T>::BasicMatrix(size_t r, size_t c)
+    : rows(r), cols(c), structure(MatrixStructure::General) {
     allocateMemory();
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
-            data[i][j] = 0.0;
+            elements[i * cols + j] = T();
         }
     }
 }
 
-Matrix::Matrix(double** arr, size_t r, size_t c) : rows(r), cols(c) {
+template <typename T>
+BasicMatrix<T>::BasicMatrix(T** arr, size_t r, size_t c)
+    : rows(r), cols(c), structure(MatrixStructure::General) {
     allocateMemory();
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
-            data[i][j] = arr[i][j];
+            elements[i * cols + j] = arr[i][j];
         }
     }
+    detectStructure();
+    selectFormat();
 }
 
-Matrix::Matrix(double num) : rows(1), cols(1) {
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const T* values, size_t r, size_t c)
+    : rows(r), cols(c), structure(MatrixStructure::General) {
     allocateMemory();
-    data[0][0] = num;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            elements[i * cols + j] = values[i * cols + j];
+        }
+    }
+    detectStructure();
+    selectFormat();
 }
 
-Matrix::Matrix(const char* str) {
+template <typename T>
+BasicMatrix<T>::BasicMatrix(T num)
+    : rows(1), cols(1), structure(MatrixStructure::General) {
+    allocateMemory();
+    elements[0] = num;
+    detectStructure();
+}
+
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const char* str)
+    : structure(MatrixStructure::General) {
     std::string input(str);
     if (input.empty() || input.front() != '[' || input.back() != ']') {
         throw InvalidMatrixFormatException(
@@ -105,7 +616,7 @@ Matrix::Matrix(const char* str) {
 
         while (std::getline(rowStream, value, ',')) {
             try {
-                data[i][j] = std::stod(value);
+                elements[i * cols + j] = ElementOps<T>::parse(value);
             } catch (const std::invalid_argument&) {
                 throw InvalidMatrixFormatException(
                     "Non-numeric value encountered");
@@ -120,223 +631,664 @@ Matrix::Matrix(const char* str) {
         }
         i++;
     }
+    detectStructure();
+    selectFormat();
 }
 
-Matrix::Matrix(const Matrix& other) : rows(other.rows), cols(other.cols) {
-    allocateMemory();
-    copyData(other);
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix& other)
+    : elements(nullptr),
+      rows(other.rows),
+      cols(other.cols),
+      structure(other.structure),
+      summaryCache(other.summaryCache),
+      summaryValid(other.summaryValid) {
+    if (other.sparse) {
+        sparse = std::make_unique<SparseStorage<T>>(*other.sparse);
+    } else if (other.elements) {
+        allocateMemory();
+        copyData(other);
+    }
 }
 
-Matrix::Matrix(Matrix&& other) noexcept
-    : data(other.data), rows(other.rows), cols(other.cols) {
-    other.data = nullptr;
+template <typename T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix&& other) noexcept
+    : elements(nullptr),
+      rows(other.rows),
+      cols(other.cols),
+      sparse(std::move(other.sparse)),
+      structure(other.structure),
+      summaryCache(other.summaryCache),
+      summaryValid(other.summaryValid) {
+    takeData(other);
     other.rows = 0;
     other.cols = 0;
+    other.structure = MatrixStructure::General;
+    other.summaryValid = false;
 }
 
-Matrix::~Matrix() { deallocateMemory(); }
+template <typename T>
+template <typename U>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix<U>& other)
+    : elements(nullptr),
+      rows(other.rows),
+      cols(other.cols),
+      structure(MatrixStructure::General) {
+    allocateMemory();
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            if (!ElementOps<T>::convert(other.valueAt(i, j),
+                                        elements[i * cols + j])) {
+                throw MatrixOverflowException("Conversion overflow");
+            }
+        }
+    }
+    // Truncation can create zeros, so the structure is detected afresh.
+    detectStructure();
+    selectFormat();
+}
+
+template <typename T>
+BasicMatrix<T>::~BasicMatrix() { deallocateMemory(); }
 
-Matrix& Matrix::operator=(const Matrix& other) {
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const BasicMatrix& other) {
     if (this != &other) {
         deallocateMemory();
+        elements = nullptr;
+        sparse.reset();
         rows = other.rows;
         cols = other.cols;
-        allocateMemory();
-        copyData(other);
+        structure = other.structure;
+        summaryCache = other.summaryCache;
+        summaryValid = other.summaryValid;
+        if (other.sparse) {
+            sparse = std::make_unique<SparseStorage<T>>(*other.sparse);
+        } else if (other.elements) {
+            allocateMemory();
+            copyData(other);
+        }
     }
     return *this;
 }
 
-Matrix& Matrix::operator=(Matrix&& other) noexcept {
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(BasicMatrix&& other) noexcept {
     if (this != &other) {
         deallocateMemory();
-        data = other.data;
         rows = other.rows;
         cols = other.cols;
-        other.data = nullptr;
+        takeData(other);
+        sparse = std::move(other.sparse);
+        structure = other.structure;
+        summaryCache = other.summaryCache;
+        summaryValid = other.summaryValid;
         other.rows = 0;
         other.cols = 0;
+        other.structure = MatrixStructure::General;
+        other.summaryValid = false;
     }
     return *this;
 }
 
-Matrix Matrix::operator+(const Matrix& other) const {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::addDiagonal(const BasicMatrix& other,
+                                           bool subtract) const {
+    BasicMatrix result(rows, cols);
+    T* out = result.elements;
+    const T* a = elements;
+    const T* b = other.elements;
+    auto kernel = [&] {
+        for (size_t k = 0; k < rows * cols; k += cols + 1) {
+            out[k] = subtract ? a[k] - b[k] : a[k] + b[k];
+        }
+    };
+    const char* message = subtract ? "Subtraction overflow"
+                                   : "Addition overflow";
+    if (runDeferred(kernel, out, rows * cols, message)) return result;
+
+    for (size_t i = 0; i < rows; ++i) {
+        size_t k = i * cols + i;
+        out[k] = addOrThrow(a[k], b[k], subtract);
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::scaleRows(const BasicMatrix& other) const {
+    // diag(d) * B scales row i of B by d(i): O(n^2) instead of O(n^3).
+    BasicMatrix result(rows, other.cols);
+    T* out = result.elements;
+    const T* b = other.elements;
+    auto kernel = [&] {
+        for (size_t i = 0; i < rows; ++i) {
+            T d = elements[i * cols + i];
+            for (size_t j = 0; j < other.cols; ++j) {
+                out[i * other.cols + j] = d * b[i * other.cols + j];
+            }
+        }
+    };
+    if (runDeferred(kernel, out, rows * other.cols,
+                    "Multiplication overflow")) {
+        return result;
+    }
+
+    for (size_t i = 0; i < rows; ++i) {
+        T d = elements[i * cols + i];
+        for (size_t j = 0; j < other.cols; ++j) {
+            size_t k = i * other.cols + j;
+            out[k] = multiplyOrThrow(d, b[k]);
+        }
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::scaleColumns(const BasicMatrix& other) const {
+    // A * diag(d) scales column j of A by d(j).
+    BasicMatrix result(rows, other.cols);
+    T* out = result.elements;
+    const T* a = elements;
+    auto kernel = [&] {
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < other.cols; ++j) {
+                out[i * cols + j] =
+                    a[i * cols + j] * other.elements[j * other.cols + j];
+            }
+        }
+    };
+    if (runDeferred(kernel, out, rows * other.cols,
+                    "Multiplication overflow")) {
+        return result;
+    }
+
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < other.cols; ++j) {
+            T d = other.elements[j * other.cols + j];
+            size_t k = i * cols + j;
+            out[k] = multiplyOrThrow(a[k], d);
+        }
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::multiplyTriangular(
+    const BasicMatrix& other) const {
+    // Both operands are upper (or both lower) triangular, so only k between
+    // i and j contributes and the other triangle of the result stays zero.
+    bool upper = isUpperKind(structure);
+    BasicMatrix result(rows, other.cols);
+    auto kernel = [&](bool checked) {
+        for (size_t i = 0; i < rows; ++i) {
+            size_t firstJ = upper ? i : 0;
+            size_t lastJ = upper ? other.cols : i + 1;
+            for (size_t j = firstJ; j < lastJ; ++j) {
+                size_t firstK = upper ? i : j;
+                size_t lastK = upper ? j + 1 : i + 1;
+                T sum = T();
+                for (size_t k = firstK; k < lastK; ++k) {
+                    T a = elements[i * cols + k];
+                    T b = other.elements[k * other.cols + j];
+                    if (checked) {
+                        multiplyAddOrThrow(sum, a, b);
+                    } else {
+                        sum += a * b;
+                    }
+                }
+                result.elements[i * other.cols + j] = sum;
+            }
+        }
+    };
+    if (!runDeferred([&] { kernel(false); }, result.elements, rows * other.cols,
+                     "Multiplication overflow")) {
+        kernel(true);
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrix& other) const& {
     if (rows != other.rows || cols != other.cols) {
         throw MatrixDimensionMismatchException(
             "Cannot add matrices of different dimensions");
     }
+    MatrixStructure kind = combineStructure(structure, other.structure);
+    if (sparse || other.sparse) {
+        BasicMatrix result = addSparse(other, false);
+        result.finishResult(kind);
+        return result;
+    }
+    if (isDiagonalKind(kind)) {
+        BasicMatrix result = addDiagonal(other, false);
+        result.finishResult(kind);
+        return result;
+    }
 
-    Matrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i) {
-        for (size_t j = 0; j < cols; ++j) {
-            if (willOverflow(data[i][j], other.data[i][j])) {
-                throw MatrixOverflowException("Addition overflow");
-            }
-            result.data[i][j] = data[i][j] + other.data[i][j];
+    BasicMatrix result(rows, cols);
+    T* out = result.elements;
+    const T* a = elements;
+    const T* b = other.elements;
+    size_t count = rows * cols;
+    auto kernel = [&] {
+        for (size_t k = 0; k < count; ++k) out[k] = a[k] + b[k];
+    };
+    if (!runDeferred(kernel, out, count, "Addition overflow")) {
+        for (size_t k = 0; k < count; ++k) {
+            out[k] = addOrThrow(a[k], b[k], false);
         }
     }
+    result.finishResult(kind);
     return result;
 }
 
-Matrix Matrix::operator-(const Matrix& other) const {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(const BasicMatrix& other) const& {
     if (rows != other.rows || cols != other.cols) {
         throw MatrixDimensionMismatchException(
             "Cannot subtract matrices of different dimensions");
     }
+    MatrixStructure kind = combineStructure(structure, other.structure);
+    if (sparse || other.sparse) {
+        BasicMatrix result = addSparse(other, true);
+        result.finishResult(kind);
+        return result;
+    }
+    if (isDiagonalKind(kind)) {
+        BasicMatrix result = addDiagonal(other, true);
+        result.finishResult(kind);
+        return result;
+    }
 
-    Matrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i) {
-        for (size_t j = 0; j < cols; ++j) {
-            if (willOverflow(data[i][j], -other.data[i][j])) {
-                throw MatrixOverflowException("Subtraction overflow");
-            }
-            result.data[i][j] = data[i][j] - other.data[i][j];
+    BasicMatrix result(rows, cols);
+    T* out = result.elements;
+    const T* a = elements;
+    const T* b = other.elements;
+    size_t count = rows * cols;
+    auto kernel = [&] {
+        for (size_t k = 0; k < count; ++k) out[k] = a[k] - b[k];
+    };
+    if (!runDeferred(kernel, out, count, "Subtraction overflow")) {
+        for (size_t k = 0; k < count; ++k) {
+            out[k] = addOrThrow(a[k], b[k], true);
         }
     }
+    result.finishResult(kind);
     return result;
 }
 
-Matrix Matrix::operator*(const Matrix& other) const {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix& other) const {
     if (rows != other.rows || cols != other.cols) {
         throw MatrixDimensionMismatchException(
             "Cannot multiply matrices of different dimensions");
     }
+    MATRIX_COUNT(MultiplyFlops, 2 * rows * cols * other.cols);
+    if (structure == MatrixStructure::Identity) return other;
+    if (other.structure == MatrixStructure::Identity) return *this;
 
-    Matrix result(rows, other.cols);
-    for (size_t i = 0; i < rows; ++i) {
-        for (size_t j = 0; j < other.cols; ++j) {
-            double sum = 0;
-            for (size_t k = 0; k < cols; ++k) {
-                if (data[i][k] != 0 && other.data[k][j] != 0) {
-                    if (std::abs(data[i][k]) >
-                        DBL_MAX / std::abs(other.data[k][j])) {
-                        throw MatrixOverflowException(
-                            "Multiplication overflow");
-                    }
+    MatrixStructure kind = combineStructure(structure, other.structure);
+    if (sparse || other.sparse) {
+        BasicMatrix result = multiplySparse(other);
+        result.finishResult(kind);
+        return result;
+    }
+    if (isDiagonalKind(structure) || isDiagonalKind(other.structure)) {
+        BasicMatrix result = isDiagonalKind(structure) ? scaleRows(other)
+                                                       : scaleColumns(other);
+        result.finishResult(kind);
+        return result;
+    }
+    if (kind != MatrixStructure::General) {
+        BasicMatrix result = multiplyTriangular(other);
+        result.finishResult(kind);
+        return result;
+    }
+
+    BasicMatrix result(rows, other.cols);
+    T* out = result.elements;
+    const T* a = elements;
+    const T* b = other.elements;
+    // Without per-term checks the blocked kernel streams rows of both the
+    // operand and the result, which the compiler can vectorize.
+    auto kernel = [&] { blockedMultiply(a, b, out, rows); };
+    if (!multiplyStrassen(a, b, out, rows) &&
+        !runDeferred(kernel, out, rows * other.cols,
+                     "Multiplication overflow")) {
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < other.cols; ++j) {
+                T sum = T();
+                for (size_t k = 0; k < cols; ++k) {
+                    multiplyAddOrThrow(sum, a[i * cols + k],
+                                       b[k * other.cols + j]);
                 }
-                sum += data[i][k] * other.data[k][j];
+                out[i * other.cols + j] = sum;
             }
-            result.data[i][j] = sum;
         }
     }
+    result.finishResult(kind);
     return result;
 }
 
-Matrix Matrix::operator/(const Matrix& other) const {
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator/(const BasicMatrix& other) const& {
     if (rows != other.rows || cols != other.cols) {
         throw MatrixDimensionMismatchException(
             "Cannot divide matrices of different dimensions");
     }
+    MatrixStructure kind = divisionStructure(structure);
+    if (sparse || other.sparse) {
+        if (!sparse) {
+            throw MatrixDivisionByZeroException(
+                "Division by zero in matrix element");
+        }
+        BasicMatrix result = divideSparse(other);
+        result.finishResult(kind);
+        return result;
+    }
 
-    Matrix result(rows, cols);
-    for (size_t i = 0; i < rows; ++i) {
-        for (size_t j = 0; j < cols; ++j) {
-            if (std::abs(other.data[i][j]) < 1e-10) {
-                throw MatrixDivisionByZeroException(
-                    "Division by zero in matrix element");
-            } else {
-                result.data[i][j] = data[i][j] / other.data[i][j];
-            }
+    BasicMatrix result(rows, cols);
+    T* out = result.elements;
+    const T* a = elements;
+    const T* b = other.elements;
+    size_t count = rows * cols;
+    auto kernel = [&] {
+        for (size_t k = 0; k < count; ++k) out[k] = a[k] / b[k];
+    };
+    if (!runDeferred(kernel, out, count, "Division overflow", b)) {
+        for (size_t k = 0; k < count; ++k) {
+            out[k] = divideOrThrow(a[k], b[k]);
         }
     }
+    result.finishResult(kind);
     return result;
 }
 
-Matrix Matrix::operator+(const char* str) const {
-    Matrix other(str);
-    return *this + other;
+template <typename T>
+bool BasicMatrix<T>::combineInPlace(const BasicMatrix& other, char op,
+                                    bool reversed) {
+    if (sparse || other.sparse || !elements || rows != other.rows ||
+        cols != other.cols) {
+        return false;
+    }
+    T* out = elements;
+    const T* a = reversed ? other.elements : elements;
+    const T* b = reversed ? elements : other.elements;
+    size_t count = rows * cols;
+
+    if (op == '/') {
+        // The deferred check reads the divisors after the kernel has run.
+        if constexpr (std::is_floating_point<T>::value) {
+            if (b == out &&
+                getOverflowCheckMode() != OverflowCheckMode::Strict) {
+                return false;
+            }
+        }
+        MatrixStructure kind =
+            divisionStructure(reversed ? other.structure : structure);
+        summaryValid = false;
+        auto kernel = [&] {
+            for (size_t k = 0; k < count; ++k) out[k] = a[k] / b[k];
+        };
+        if (!runDeferred(kernel, out, count, "Division overflow", b)) {
+            for (size_t k = 0; k < count; ++k) {
+                out[k] = divideOrThrow(a[k], b[k]);
+            }
+        }
+        finishResult(kind);
+        return true;
+    }
+
+    // Off-diagonal zeros of two diagonal operands stay zero, so only the
+    // diagonal is rewritten, as addDiagonal() does.
+    MatrixStructure kind = combineStructure(structure, other.structure);
+    bool subtract = op == '-';
+    size_t step = isDiagonalKind(kind) ? cols + 1 : 1;
+    summaryValid = false;
+    auto kernel = [&] {
+        if (subtract) {
+            for (size_t k = 0; k < count; k += step) out[k] = a[k] - b[k];
+        } else {
+            for (size_t k = 0; k < count; k += step) out[k] = a[k] + b[k];
+        }
+    };
+    const char* message = subtract ? "Subtraction overflow"
+                                   : "Addition overflow";
+    if (!runDeferred(kernel, out, count, message)) {
+        for (size_t k = 0; k < count; k += step) {
+            out[k] = addOrThrow(a[k], b[k], subtract);
+        }
+    }
+    finishResult(kind);
+    return true;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::combineReusing(const BasicMatrix& left,
+                                              const BasicMatrix& right,
+                                              char op, BasicMatrix* spareLeft,
+                                              BasicMatrix* spareRight) {
+    if (spareLeft && spareLeft->combineInPlace(right, op, false)) {
+        return std::move(*spareLeft);
+    }
+    if (spareRight && spareRight->combineInPlace(left, op, true)) {
+        return std::move(*spareRight);
+    }
+    switch (op) {
+        case '+':
+            return left + right;
+        case '-':
+            return left - right;
+        default:
+            return left / right;
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrix& other) && {
+    return combineReusing(*this, other, '+', this, nullptr);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(BasicMatrix&& other) && {
+    return combineReusing(*this, other, '+', this, &other);
+}
+
+template <typename T>
+BasicMatrix<T> operator+(const BasicMatrix<T>& left, BasicMatrix<T>&& right) {
+    return BasicMatrix<T>::combineReusing(left, right, '+', nullptr, &right);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(const BasicMatrix& other) && {
+    return combineReusing(*this, other, '-', this, nullptr);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(BasicMatrix&& other) && {
+    return combineReusing(*this, other, '-', this, &other);
+}
+
+template <typename T>
+BasicMatrix<T> operator-(const BasicMatrix<T>& left, BasicMatrix<T>&& right) {
+    return BasicMatrix<T>::combineReusing(left, right, '-', nullptr, &right);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator/(const BasicMatrix& other) && {
+    return combineReusing(*this, other, '/', this, nullptr);
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator/(BasicMatrix&& other) && {
+    return combineReusing(*this, other, '/', this, &other);
+}
+
+template <typename T>
+BasicMatrix<T> operator/(const BasicMatrix<T>& left, BasicMatrix<T>&& right) {
+    return BasicMatrix<T>::combineReusing(left, right, '/', nullptr, &right);
+}
+
+// The parsed form of str, from this thread's cache of recent literals. The
+// reference stays valid until the next call on the same thread.
+template <typename T>
+static const BasicMatrix<T>& parsedLiteral(const char* str,
+                                           BasicMatrix<T>& uncached) {
+    using Entry = std::pair<std::string, BasicMatrix<T>>;
+    // Most recently used first; index keys view the strings in entries.
+    thread_local std::list<Entry> entries;
+    thread_local std::unordered_map<std::string_view,
+                                    typename std::list<Entry>::iterator>
+        index;
+
+    std::string_view key(str);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->second;
+    }
+    if (key.size() > LITERAL_CACHE_MAX_LENGTH) {
+        uncached = BasicMatrix<T>(str);
+        return uncached;
+    }
+
+    // Parse first, so a malformed literal throws without evicting anything.
+    BasicMatrix<T> parsed(str);
+    if (entries.size() == LITERAL_CACHE_CAPACITY) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(std::string(key), std::move(parsed));
+    index.emplace(entries.front().first, entries.begin());
+    return entries.front().second;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const char* str) const {
+    BasicMatrix uncached;
+    return *this + parsedLiteral(str, uncached);
 }
 
-Matrix operator+(const char* str, const Matrix& matrix) {
-    Matrix other(str);
-    return other + matrix;
+template <typename T>
+BasicMatrix<T> operator+(const char* str, const BasicMatrix<T>& matrix) {
+    BasicMatrix<T> uncached;
+    return parsedLiteral(str, uncached) + matrix;
 }
 
-Matrix Matrix::operator-(const char* str) const {
-    Matrix other(str);
-    return *this - other;
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator-(const char* str) const {
+    BasicMatrix uncached;
+    return *this - parsedLiteral(str, uncached);
 }
 
-Matrix operator-(const char* str, const Matrix& matrix) {
-    Matrix other(str);
-    return other - matrix;
+template <typename T>
+BasicMatrix<T> operator-(const char* str, const BasicMatrix<T>& matrix) {
+    BasicMatrix<T> uncached;
+    return parsedLiteral(str, uncached) - matrix;
 }
 
-Matrix Matrix::operator*(const char* str) const {
-    Matrix other(str);
-    return *this * other;
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const char* str) const {
+    BasicMatrix uncached;
+    return *this * parsedLiteral(str, uncached);
 }
 
-Matrix operator*(const char* str, const Matrix& matrix) {
-    Matrix other(str);
-    return other * matrix;
+template <typename T>
+BasicMatrix<T> operator*(const char* str, const BasicMatrix<T>& matrix) {
+    BasicMatrix<T> uncached;
+    return parsedLiteral(str, uncached) * matrix;
 }
 
-Matrix Matrix::operator/(const char* str) const {
-    Matrix other(str);
-    return *this / other;
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::operator/(const char* str) const {
+    BasicMatrix uncached;
+    return *this / parsedLiteral(str, uncached);
 }
 
-Matrix operator/(const char* str, const Matrix& matrix) {
-    Matrix other(str);
-    return other / matrix;
+template <typename T>
+BasicMatrix<T> operator/(const char* str, const BasicMatrix<T>& matrix) {
+    BasicMatrix<T> uncached;
+    return parsedLiteral(str, uncached) / matrix;
 }
 
-Matrix& Matrix::operator+=(const Matrix& other) {
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const BasicMatrix& other) {
     *this = *this + other;
     return *this;
 }
 
-Matrix& Matrix::operator-=(const Matrix& other) {
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator-=(const BasicMatrix& other) {
     *this = *this - other;
     return *this;
 }
 
-Matrix& Matrix::operator*=(const Matrix& other) {
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(const BasicMatrix& other) {
     *this = *this * other;
     return *this;
 }
 
-Matrix& Matrix::operator/=(const Matrix& other) {
+template <typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator/=(const BasicMatrix& other) {
     *this = *this / other;
     return *this;
 }
 
-bool Matrix::operator==(const Matrix& other) const {
+template <typename T>
+bool BasicMatrix<T>::operator==(const BasicMatrix& other) const {
     if (rows != other.rows || cols != other.cols) return false;
+    if (summaryValid && other.summaryValid &&
+        summaryCache.hash != other.summaryCache.hash) {
+        return false;
+    }
+
+    if (sparse && other.sparse) {
+        return sparse->rowPtr == other.sparse->rowPtr &&
+               sparse->colIndex == other.sparse->colIndex &&
+               sparse->values == other.sparse->values;
+    }
 
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
-            if (data[i][j] != other.data[i][j]) return false;
+            if (valueAt(i, j) != other.valueAt(i, j)) return false;
         }
     }
     return true;
 }
 
-bool Matrix::operator!=(const Matrix& other) const { return !(*this == other); }
+template <typename T>
+bool BasicMatrix<T>::operator!=(const BasicMatrix& other) const {
+    return !(*this == other);
+}
 
-bool Matrix::operator<(const Matrix& other) const {
+template <typename T>
+bool BasicMatrix<T>::operator<(const BasicMatrix& other) const {
     return sum() < other.sum();
 }
 
-bool Matrix::operator>(const Matrix& other) const {
+template <typename T>
+bool BasicMatrix<T>::operator>(const BasicMatrix& other) const {
     return sum() > other.sum();
 }
 
-bool Matrix::operator<=(const Matrix& other) const {
+template <typename T>
+bool BasicMatrix<T>::operator<=(const BasicMatrix& other) const {
     return sum() <= other.sum();
 }
 
-bool Matrix::operator>=(const Matrix& other) const {
+template <typename T>
+bool BasicMatrix<T>::operator>=(const BasicMatrix& other) const {
     return sum() >= other.sum();
 }
 
-std::string Matrix::toString() const {
+template <typename T>
+std::string BasicMatrix<T>::toString() const {
     std::stringstream ss;
     ss << "[";
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
-            ss << data[i][j];
+            ss << valueAt(i, j);
             if (j < cols - 1) ss << ",";
         }
         if (i < rows - 1) ss << ";";
@@ -345,19 +1297,160 @@ std::string Matrix::toString() const {
     return ss.str();
 }
 
-double& Matrix::operator()(size_t row, size_t col) {
+template <typename T>
+void BasicMatrix<T>::prepareWrite() {
+    // A writable reference needs a real cell, and the caller may break
+    // whatever structure the matrix had.
+    toDense();
+    structure = MatrixStructure::General;
+    summaryValid = false;
+}
+
+template <typename T>
+const T& BasicMatrix<T>::sparseValue(size_t row, size_t col) const {
+    static const T ZERO = T();
+    const T* value = sparse->find(row, col);
+    return value ? *value : ZERO;
+}
+
+template <typename T>
+T& BasicMatrix<T>::at(size_t row, size_t col) {
     if (row >= rows || col >= cols) {
         throw MatrixException("Index out of bounds");
     }
-    return data[row][col];
+    return (*this)(row, col);
 }
 
-const double& Matrix::operator()(size_t row, size_t col) const {
+template <typename T>
+const T& BasicMatrix<T>::at(size_t row, size_t col) const {
     if (row >= rows || col >= cols) {
         throw MatrixException("Index out of bounds");
     }
-    return data[row][col];
+    return (*this)(row, col);
+}
+
+template <typename T>
+T* BasicMatrix<T>::data() {
+    if (!readyForWrite()) prepareWrite();
+    return elements;
 }
 
-size_t Matrix::getRows() const { return rows; }
-size_t Matrix::getCols() const { return cols; }
+template <typename T>
+const T* BasicMatrix<T>::data() const {
+    if (sparse) {
+        throw MatrixException("Sparse matrix has no dense data");
+    }
+    return elements;
+}
+
+template <typename T>
+size_t BasicMatrix<T>::stride() const { return cols; }
+
+template <typename T>
+std::span<T> BasicMatrix<T>::row(size_t index) {
+    assert(index < rows);
+    return std::span<T>(data() + index * cols, cols);
+}
+
+template <typename T>
+std::span<const T> BasicMatrix<T>::row(size_t index) const {
+    assert(index < rows);
+    return std::span<const T>(data() + index * cols, cols);
+}
+
+template <typename T>
+std::vector<T> BasicMatrix<T>::multiplyVector(
+    const std::vector<T>& vector) const {
+    if (vector.size() != cols) {
+        throw MatrixDimensionMismatchException(
+            "Vector length must match the number of matrix columns");
+    }
+
+    std::vector<T> result(rows, T());
+    for (size_t i = 0; i < rows; ++i) {
+        T sum = T();
+        if (sparse) {
+            for (size_t p = sparse->rowPtr[i]; p < sparse->rowPtr[i + 1];
+                 ++p) {
+                multiplyAddOrThrow(sum, sparse->values[p],
+                                   vector[sparse->colIndex[p]]);
+            }
+        } else {
+            for (size_t k = 0; k < cols; ++k) {
+                multiplyAddOrThrow(sum, elements[i * cols + k], vector[k]);
+            }
+        }
+        result[i] = sum;
+    }
+    return result;
+}
+
+template <typename T>
+size_t BasicMatrix<T>::getRows() const { return rows; }
+
+template <typename T>
+size_t BasicMatrix<T>::getCols() const { return cols; }
+
+template <typename T>
+MatrixStructure BasicMatrix<T>::getStructure() const { return structure; }
+
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::view() const {
+    return BasicMatrixView<T>(*this);
+}
+
+template <typename T>
+bool BasicMatrix<T>::hasSummary() const { return summaryValid; }
+
+template <typename T>
+bool BasicMatrix<T>::isSparse() const { return sparse != nullptr; }
+
+template <typename T>
+size_t BasicMatrix<T>::nonZeros() const {
+    if (sparse) return sparse->nonZeros();
+
+    size_t count = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            if (elements[i * cols + j] != T()) count++;
+        }
+    }
+    return count;
+}
+
+template class BasicMatrix<float>;
+template class BasicMatrix<double>;
+template class BasicMatrix<int64_t>;
+
+template BasicMatrix<float>::BasicMatrix(const BasicMatrix<double>&);
+template BasicMatrix<float>::BasicMatrix(const BasicMatrix<int64_t>&);
+template BasicMatrix<double>::BasicMatrix(const BasicMatrix<float>&);
+template BasicMatrix<double>::BasicMatrix(const BasicMatrix<int64_t>&);
+template BasicMatrix<int64_t>::BasicMatrix(const BasicMatrix<float>&);
+template BasicMatrix<int64_t>::BasicMatrix(const BasicMatrix<double>&);
+
+#define INSTANTIATE_STRING_OPERATORS(T)                                  \
+    template BasicMatrix<T> operator+(const char*, const BasicMatrix<T>&); \
+    template BasicMatrix<T> operator-(const char*, const BasicMatrix<T>&); \
+    template BasicMatrix<T> operator*(const char*, const BasicMatrix<T>&); \
+    template BasicMatrix<T> operator/(const char*, const BasicMatrix<T>&);
+
+INSTANTIATE_STRING_OPERATORS(float)
+INSTANTIATE_STRING_OPERATORS(double)
+INSTANTIATE_STRING_OPERATORS(int64_t)
+
+#undef INSTANTIATE_STRING_OPERATORS
+
+#define INSTANTIATE_RVALUE_OPERATORS(T)                       \
+    template BasicMatrix<T> operator+(const BasicMatrix<T>&,  \
+                                      BasicMatrix<T>&&);      \
+    template BasicMatrix<T> operator-(const BasicMatrix<T>&,  \
+                                      BasicMatrix<T>&&);      \
+    template BasicMatrix<T> operator/(const BasicMatrix<T>&,  \
+                                      BasicMatrix<T>&&);
+
+INSTANTIATE_RVALUE_OPERATORS(float)
+INSTANTIATE_RVALUE_OPERATORS(double)
+INSTANTIATE_RVALUE_OPERATORS(int64_t)
+
+#undef INSTANTIATE_RVALUE_OPERATORS
@@ -0,0 +1,273 @@
+#include "MatrixAllocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#define MATRIX_ALLOCATOR_USE_MADVISE 1
+#include <sys/mman.h>
+#endif
+
+static const size_t BLOCK_ALIGNMENT = 64;
+static const size_t MIN_CLASS_SHIFT = 6;
+static const size_t CLASS_COUNT = 11;
+
+static_assert(size_t(1) << MIN_CLASS_SHIFT ==
+              PoolMatrixAllocator::MIN_POOLED_BYTES);
+static_assert(size_t(1) << (MIN_CLASS_SHIFT + CLASS_COUNT - 1) ==
+              PoolMatrixAllocator::MAX_POOLED_BYTES);
+
+static size_t roundUp(size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+static void* alignedOrThrow(size_t alignment, size_t bytes) {
+    void* block = std::aligned_alloc(alignment, roundUp(bytes, alignment));
+    if (!block) throw std::bad_alloc();
+    return block;
+}
+
+// Smallest class whose blocks hold bytes; bytes <= MAX_POOLED_BYTES.
+static size_t sizeClass(size_t bytes) {
+    size_t index = 0;
+    while ((size_t(1) << (MIN_CLASS_SHIFT + index)) < bytes) index++;
+    return index;
+}
+
+static size_t classBytes(size_t index) {
+    return size_t(1) << (MIN_CLASS_SHIFT + index);
+}
+
+namespace {
+
+// Blocks are at least MIN_POOLED_BYTES, so the size class fits next to the
+// link.
+struct FreeBlock {
+    FreeBlock* next;
+    size_t index;
+};
+
+// The remote list of a pool whose thread has exited.
+FreeBlock* const CLOSED = reinterpret_cast<FreeBlock*>(uintptr_t(1));
+
+void freeChain(FreeBlock* block) {
+    while (block) {
+        FreeBlock* next = block->next;
+        std::free(block);
+        block = next;
+    }
+}
+
+// One thread's free lists. Only the owning thread touches heads and stats.
+// Other threads hand blocks back through the lock-free remote list, which
+// the owner takes over in one exchange once a size class runs dry.
+//
+// A matrix keeps the pool that made its buffer, and may outlive the
+// thread, so pools are never destroyed. The pool of an exited thread is
+// closed, sending late frees to the heap, and reused by the next new
+// thread; there are only as many pools as threads alive at once.
+class ThreadPool : public MatrixAllocator {
+   public:
+    FreeBlock* heads[CLASS_COUNT] = {};
+    MatrixPoolStats stats = {};
+    // On its own cache line: other threads write it.
+    alignas(64) std::atomic<FreeBlock*> remote{nullptr};
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* block, size_t bytes) override;
+
+    void keep(FreeBlock* block);
+    void adoptRemote();
+    void releaseAll();
+};
+
+thread_local ThreadPool* threadPool = nullptr;
+// Set once the thread's PoolReaper has run; the thread then allocates from
+// the heap.
+thread_local bool threadExited = false;
+
+struct PoolRegistry {
+    std::mutex mutex;
+    std::vector<ThreadPool*> idle;
+};
+
+PoolRegistry& registry() {
+    // Never destroyed: threads may still exit after static destruction.
+    static PoolRegistry* instance = new PoolRegistry();
+    return *instance;
+}
+
+struct PoolReaper {
+    ~PoolReaper() {
+        ThreadPool* pool = threadPool;
+        threadPool = nullptr;
+        threadExited = true;
+        pool->releaseAll();
+        freeChain(pool->remote.exchange(CLOSED, std::memory_order_acquire));
+        PoolRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.idle.push_back(pool);
+    }
+};
+
+// nullptr once the thread has released its pool.
+ThreadPool* localPool() {
+    if (threadPool || threadExited) return threadPool;
+    ThreadPool* pool;
+    {
+        PoolRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (r.idle.empty()) {
+            pool = new ThreadPool();
+        } else {
+            pool = r.idle.back();
+            r.idle.pop_back();
+            pool->stats = {};
+            pool->remote.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    threadPool = pool;
+    // Constructed on the first pool use in each thread, so it is destroyed
+    // before any thread_local that already held a matrix at that point.
+    thread_local PoolReaper reaper;
+    (void)reaper;
+    return pool;
+}
+
+HeapMatrixAllocator& heapAllocator() {
+    static HeapMatrixAllocator* instance = new HeapMatrixAllocator();
+    return *instance;
+}
+
+void* ThreadPool::allocate(size_t bytes) {
+    if (bytes > PoolMatrixAllocator::MAX_POOLED_BYTES) {
+        stats.largeRequests++;
+        if (bytes < PoolMatrixAllocator::HUGE_PAGE_SIZE) {
+            return alignedOrThrow(BLOCK_ALIGNMENT, bytes);
+        }
+        stats.hugePageRequests++;
+        const size_t hugePage = PoolMatrixAllocator::HUGE_PAGE_SIZE;
+        void* block = alignedOrThrow(hugePage, bytes);
+#ifdef MATRIX_ALLOCATOR_USE_MADVISE
+        // Only advice: the buffer works the same if the kernel says no.
+        ::madvise(block, roundUp(bytes, hugePage), MADV_HUGEPAGE);
+#endif
+        return block;
+    }
+
+    size_t index = sizeClass(bytes);
+    stats.pooledRequests++;
+    if (!heads[index] && remote.load(std::memory_order_relaxed)) {
+        adoptRemote();
+    }
+    if (FreeBlock* block = heads[index]) {
+        heads[index] = block->next;
+        stats.poolHits++;
+        stats.retainedBytes -= classBytes(index);
+        return block;
+    }
+    return alignedOrThrow(BLOCK_ALIGNMENT, classBytes(index));
+}
+
+void ThreadPool::deallocate(void* block, size_t bytes) {
+    if (!block) return;
+    if (bytes > PoolMatrixAllocator::MAX_POOLED_BYTES) {
+        std::free(block);
+        return;
+    }
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->index = sizeClass(bytes);
+    if (this == threadPool) {
+        keep(freed);
+        return;
+    }
+
+    FreeBlock* head = remote.load(std::memory_order_relaxed);
+    do {
+        if (head == CLOSED) {
+            std::free(freed);
+            return;
+        }
+        freed->next = head;
+    } while (!remote.compare_exchange_weak(head, freed,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+}
+
+void ThreadPool::keep(FreeBlock* block) {
+    size_t bytes = classBytes(block->index);
+    if (stats.retainedBytes + bytes > PoolMatrixAllocator::MAX_RETAINED_BYTES) {
+        std::free(block);
+        return;
+    }
+    block->next = heads[block->index];
+    heads[block->index] = block;
+    stats.retainedBytes += bytes;
+}
+
+void ThreadPool::adoptRemote() {
+    FreeBlock* block = remote.exchange(nullptr, std::memory_order_acquire);
+    while (block) {
+        FreeBlock* next = block->next;
+        stats.remoteFrees++;
+        keep(block);
+        block = next;
+    }
+}
+
+void ThreadPool::releaseAll() {
+    for (size_t c = 0; c < CLASS_COUNT; ++c) {
+        freeChain(heads[c]);
+        heads[c] = nullptr;
+    }
+    stats.retainedBytes = 0;
+}
+
+}  // namespace
+
+void* HeapMatrixAllocator::allocate(size_t bytes) {
+    return alignedOrThrow(BLOCK_ALIGNMENT, bytes);
+}
+
+void HeapMatrixAllocator::deallocate(void* block, size_t) { std::free(block); }
+
+void* PoolMatrixAllocator::allocate(size_t bytes) {
+    return threadAllocator()->allocate(bytes);
+}
+
+void PoolMatrixAllocator::deallocate(void* block, size_t bytes) {
+    threadAllocator()->deallocate(block, bytes);
+}
+
+MatrixAllocator* PoolMatrixAllocator::threadAllocator() {
+    ThreadPool* pool = localPool();
+    if (!pool) return &heapAllocator();
+    return pool;
+}
+
+MatrixPoolStats PoolMatrixAllocator::threadStats() {
+    ThreadPool* pool = localPool();
+    return pool ? pool->stats : MatrixPoolStats{};
+}
+
+void PoolMatrixAllocator::trim() {
+    ThreadPool* pool = localPool();
+    if (!pool) return;
+    pool->releaseAll();
+    freeChain(pool->remote.exchange(nullptr, std::memory_order_acquire));
+}
+
+static std::atomic<MatrixAllocator*> currentAllocator{nullptr};
+
+void setMatrixAllocator(MatrixAllocator* allocator) {
+    currentAllocator.store(allocator, std::memory_order_release);
+}
+
+MatrixAllocator* getMatrixAllocator() {
+    MatrixAllocator* allocator =
+        currentAllocator.load(std::memory_order_acquire);
+    return allocator ? allocator : PoolMatrixAllocator::threadAllocator();
+}
@@ -0,0 +1,193 @@
+#include "MatrixArchive.h"
+#include "MatrixException.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Archive layout (native endianness, every section 8-byte aligned):
+//   ArchiveHeader
+//   double[]                       - row-major values of each matrix
+//   MatrixArchiveEntry[count]      - index, by id
+//   ArchiveFooter
+const char ARCHIVE_MAGIC[8] = {'M', 'X', 'A', 'R', 'C', 'H', '0', '1'};
+const uint32_t ARCHIVE_VERSION = 1;
+const uint32_t ARCHIVE_BYTE_ORDER = 0x01020304;
+
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+};
+
+struct ArchiveFooter {
+    uint64_t indexOffset;
+    uint64_t count;
+    char magic[8];
+};
+
+const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+uint64_t checksumWords(const double* values, size_t count,
+                       uint64_t hash = FNV_OFFSET_BASIS) {
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t word;
+        std::memcpy(&word, &values[i], sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    return hash;
+}
+
+}  // namespace
+
+MatrixArchiveWriter::MatrixArchiveWriter(const std::string& path)
+    : path(path),
+      out(path, std::ios::binary | std::ios::trunc),
+      offset(sizeof(ArchiveHeader)),
+      finished(false) {
+    if (!out.is_open()) {
+        throw MatrixException("Unable to open file: " + path);
+    }
+    ArchiveHeader header = {};
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.byteOrder = ARCHIVE_BYTE_ORDER;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+MatrixArchiveWriter::~MatrixArchiveWriter() {
+    if (finished) return;
+    try {
+        finish();
+    } catch (...) {
+    }
+}
+
+uint64_t MatrixArchiveWriter::append(const Matrix& matrix) {
+    if (finished) {
+        throw MatrixException("Archive is already finished: " + path);
+    }
+    MatrixArchiveEntry entry = {offset, matrix.getRows(), matrix.getCols(),
+                                FNV_OFFSET_BASIS};
+    // Element access works for sparse storage too, as in saveSnapshot().
+    row.resize(entry.cols);
+    for (size_t r = 0; r < entry.rows; ++r) {
+        for (size_t c = 0; c < entry.cols; ++c) row[c] = matrix(r, c);
+        entry.checksum = checksumWords(row.data(), row.size(), entry.checksum);
+        out.write(reinterpret_cast<const char*>(row.data()),
+                  row.size() * sizeof(double));
+    }
+    offset += entry.rows * entry.cols * sizeof(double);
+    index.push_back(entry);
+    return index.size() - 1;
+}
+
+void MatrixArchiveWriter::finish() {
+    if (finished) return;
+    finished = true;
+
+    ArchiveFooter footer = {};
+    footer.indexOffset = offset;
+    footer.count = index.size();
+    std::memcpy(footer.magic, ARCHIVE_MAGIC, sizeof(footer.magic));
+    out.write(reinterpret_cast<const char*>(index.data()),
+              index.size() * sizeof(MatrixArchiveEntry));
+    out.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+    out.close();
+    if (!out) {
+        throw MatrixException("Failed to write archive: " + path);
+    }
+}
+
+MatrixArchiveLoader::MatrixArchiveLoader(const std::string& path)
+    : file(path, MappedFile::Access::Random),
+      index(nullptr),
+      count(0),
+      valuesEnd(0),
+      cursor(0) {
+    const char* bytes = file.data();
+    if (file.size() < sizeof(ArchiveHeader) + sizeof(ArchiveFooter)) {
+        throw MatrixException("Invalid archive: file is truncated");
+    }
+
+    ArchiveHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    ArchiveFooter footer;
+    std::memcpy(&footer, bytes + file.size() - sizeof(footer), sizeof(footer));
+    if (std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != ARCHIVE_VERSION ||
+        header.byteOrder != ARCHIVE_BYTE_ORDER) {
+        throw MatrixException("Invalid archive: unsupported format");
+    }
+    if (std::memcmp(footer.magic, ARCHIVE_MAGIC, sizeof(footer.magic)) != 0) {
+        throw MatrixException("Invalid archive: file is truncated");
+    }
+
+    uint64_t indexBytes = file.size() - sizeof(footer) - footer.indexOffset;
+    if (footer.indexOffset < sizeof(header) ||
+        footer.indexOffset > file.size() - sizeof(footer) ||
+        footer.indexOffset % sizeof(double) != 0 ||
+        indexBytes / sizeof(MatrixArchiveEntry) != footer.count ||
+        indexBytes % sizeof(MatrixArchiveEntry) != 0) {
+        throw MatrixException("Invalid archive: index out of bounds");
+    }
+
+    // The index starts on an 8-byte boundary of a page-aligned mapping, so
+    // it is read in place.
+    index = reinterpret_cast<const MatrixArchiveEntry*>(bytes +
+                                                        footer.indexOffset);
+    count = footer.count;
+    valuesEnd = footer.indexOffset;
+}
+
+uint64_t MatrixArchiveLoader::size() const { return count; }
+
+const MatrixArchiveEntry& MatrixArchiveLoader::entry(uint64_t id) const {
+    if (id >= count) {
+        throw MatrixException("Archive id out of range: " +
+                              std::to_string(id));
+    }
+    return index[id];
+}
+
+Matrix MatrixArchiveLoader::GetItem(uint64_t id) const {
+    TraceScope trace("MatrixArchiveLoader::GetItem");
+    const MatrixArchiveEntry& e = entry(id);
+    uint64_t available = (valuesEnd - std::min(e.offset, valuesEnd)) /
+                         sizeof(double);
+    if (e.offset < sizeof(ArchiveHeader) || e.offset % sizeof(double) != 0 ||
+        (e.rows != 0 && e.cols > available / e.rows)) {
+        throw MatrixException("Invalid archive: values out of bounds for id " +
+                              std::to_string(id));
+    }
+
+    size_t valueCount = e.rows * e.cols;
+    const double* values =
+        reinterpret_cast<const double*>(file.data() + e.offset);
+    if (checksumWords(values, valueCount) != e.checksum) {
+        throw MatrixException("Invalid archive: checksum mismatch for id " +
+                              std::to_string(id));
+    }
+
+    MATRIX_COUNT(LoaderItems, 1);
+    MATRIX_COUNT(LoaderBytes, valueCount * sizeof(double));
+    Matrix item(values, e.rows, e.cols);
+    trace.describe(e.rows, e.cols, valueCount * sizeof(double));
+    return item;
+}
+
+Matrix MatrixArchiveLoader::GetItem() {
+    if (cursor >= count) {
+        throw MatrixException("MatrixArchiveLoader has no more items");
+    }
+    Matrix item = GetItem(cursor);
+    cursor++;
+    return item;
+}
+
+bool MatrixArchiveLoader::HasNext() { return cursor < count; }
+
+bool MatrixArchiveLoader::CanReadAhead() const { return true; }
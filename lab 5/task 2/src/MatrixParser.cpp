@@ -0,0 +1,73 @@
+#include "MatrixParser.h"
+
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+#include <vector>
+
+#include "MatrixException.h"
+
+static const char* skipBlanks(const char* p, const char* end) {
+    while (p != end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+static void checkColumns(size_t rowCols, size_t cols) {
+    if (rowCols != cols) {
+        throw InvalidMatrixFormatException("Inconsistent number of columns");
+    }
+}
+
+template <typename T>
+BasicMatrix<T> parseMatrix(std::string_view text) {
+    if (text.size() < 2 || text.front() != '[' || text.back() != ']') {
+        throw InvalidMatrixFormatException(
+            "Matrix must start with '[' and end with ']'");
+    }
+
+    // Reused by every call on this thread, so steady-state parsing only
+    // allocates the matrix itself.
+    thread_local std::vector<T> values;
+    values.clear();
+
+    const char* p = text.data() + 1;
+    const char* end = text.data() + text.size() - 1;
+    size_t rows = 1;
+    size_t cols = 0;
+    size_t rowCols = 0;
+    for (;;) {
+        p = skipBlanks(p, end);
+        // from_chars takes no '+', which stod did.
+        if (p != end && *p == '+' && p + 1 != end && p[1] != '-') ++p;
+        T value;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec == std::errc::invalid_argument) {
+            throw InvalidMatrixFormatException("Non-numeric value encountered");
+        }
+        if (result.ec == std::errc::result_out_of_range) {
+            throw MatrixOverflowException("Value out of range");
+        }
+        values.push_back(value);
+        rowCols++;
+
+        p = skipBlanks(result.ptr, end);
+        if (p == end) break;
+        if (*p == ';') {
+            if (rows == 1) cols = rowCols;
+            checkColumns(rowCols, cols);
+            rows++;
+            rowCols = 0;
+        } else if (*p != ',') {
+            throw InvalidMatrixFormatException("Non-numeric value encountered");
+        }
+        ++p;
+    }
+    if (rows == 1) cols = rowCols;
+    checkColumns(rowCols, cols);
+
+    return BasicMatrix<T>(values.data(), rows, cols);
+}
+
+template BasicMatrix<float> parseMatrix<float>(std::string_view text);
+template BasicMatrix<double> parseMatrix<double>(std::string_view text);
+template BasicMatrix<int64_t> parseMatrix<int64_t>(std::string_view text);
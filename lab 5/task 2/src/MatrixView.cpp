@@ -0,0 +1,227 @@
+#include "MatrixView.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "CheckedArithmetic.h"
+
+// Tiles of up to this many elements are copied directly; 16 x 16 doubles
+// plus the matching destination rows fit in L1.
+static const size_t COPY_TILE_ELEMENTS = 256;
+
+template <typename T>
+BasicMatrixView<T>::BasicMatrixView(const T* data, size_t rows, size_t cols,
+                                    size_t rowStride, size_t colStride)
+    : data(data),
+      rows(rows),
+      cols(cols),
+      rowStride(rowStride),
+      colStride(colStride) {}
+
+template <typename T>
+BasicMatrixView<T>::BasicMatrixView(const BasicMatrix<T>& matrix)
+    : data(matrix.elements),
+      rows(matrix.rows),
+      cols(matrix.cols),
+      rowStride(matrix.cols),
+      colStride(1) {
+    if (matrix.sparse) {
+        throw MatrixException("Cannot view a sparse matrix");
+    }
+}
+
+template <typename T>
+size_t BasicMatrixView<T>::getRows() const { return rows; }
+
+template <typename T>
+size_t BasicMatrixView<T>::getCols() const { return cols; }
+
+template <typename T>
+size_t BasicMatrixView<T>::getRowStride() const { return rowStride; }
+
+template <typename T>
+size_t BasicMatrixView<T>::getColStride() const { return colStride; }
+
+template <typename T>
+const T& BasicMatrixView<T>::at(size_t row, size_t col) const {
+    if (row >= rows || col >= cols) {
+        throw MatrixException("Index out of bounds");
+    }
+    return (*this)(row, col);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::block(size_t firstRow, size_t firstCol,
+                                             size_t rowCount,
+                                             size_t colCount) const {
+    if (firstRow > rows || rowCount > rows - firstRow || firstCol > cols ||
+        colCount > cols - firstCol) {
+        throw MatrixException("Block out of bounds");
+    }
+    return BasicMatrixView(data + firstRow * rowStride + firstCol * colStride,
+                           rowCount, colCount, rowStride, colStride);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::row(size_t index) const {
+    return block(index, 0, 1, cols);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::column(size_t index) const {
+    return block(0, index, rows, 1);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::transpose() const {
+    return BasicMatrixView(data, cols, rows, colStride, rowStride);
+}
+
+template <typename T>
+void copyCacheOblivious(const T* src, size_t srcRowStride, size_t srcColStride,
+                        T* dst, size_t dstStride, size_t rows, size_t cols) {
+    if (rows * cols <= COPY_TILE_ELEMENTS) {
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                dst[i * dstStride + j] =
+                    src[i * srcRowStride + j * srcColStride];
+            }
+        }
+        return;
+    }
+    if (rows >= cols) {
+        size_t half = rows / 2;
+        copyCacheOblivious(src, srcRowStride, srcColStride, dst, dstStride,
+                           half, cols);
+        copyCacheOblivious(src + half * srcRowStride, srcRowStride,
+                           srcColStride, dst + half * dstStride, dstStride,
+                           rows - half, cols);
+    } else {
+        size_t half = cols / 2;
+        copyCacheOblivious(src, srcRowStride, srcColStride, dst, dstStride,
+                           rows, half);
+        copyCacheOblivious(src + half * srcColStride, srcRowStride,
+                           srcColStride, dst + half, dstStride, rows,
+                           cols - half);
+    }
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixView<T>::toMatrix() const {
+    BasicMatrix<T> result(rows, cols);
+    if (colStride == 1) {
+        for (size_t i = 0; i < rows; ++i) {
+            std::memcpy(result.elements + i * cols, data + i * rowStride,
+                        cols * sizeof(T));
+        }
+    } else {
+        copyCacheOblivious(data, rowStride, colStride, result.elements, cols,
+                           rows, cols);
+    }
+    result.detectStructure();
+    result.selectFormat();
+    return result;
+}
+
+template <typename T>
+T BasicMatrixView<T>::sum() const {
+    T result = T();
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            if (!ElementOps<T>::accumulate(result, (*this)(i, j))) {
+                throw MatrixOverflowException("Sum overflow");
+            }
+        }
+    }
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixView<T>::add(const BasicMatrixView& a,
+                                       const BasicMatrixView& b,
+                                       bool subtract) {
+    if (a.rows != b.rows || a.cols != b.cols) {
+        throw MatrixDimensionMismatchException(
+            subtract ? "Cannot subtract matrices of different dimensions"
+                     : "Cannot add matrices of different dimensions");
+    }
+    BasicMatrix<T> result(a.rows, a.cols);
+    for (size_t i = 0; i < a.rows; ++i) {
+        T* out = result.elements + i * a.cols;
+        for (size_t j = 0; j < a.cols; ++j) {
+            out[j] = addOrThrow(a(i, j), b(i, j), subtract);
+        }
+    }
+    result.detectStructure();
+    result.selectFormat();
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixView<T>::multiply(const BasicMatrixView& a,
+                                            const BasicMatrixView& b) {
+    // Views make non-square operands easy to form, so this is the general
+    // product: a is rows x k, b is k x cols.
+    if (a.cols != b.rows) {
+        throw MatrixDimensionMismatchException(
+            "Cannot multiply matrices of different dimensions");
+    }
+    // i-k-j order: b and the result are walked along their rows, whatever
+    // a's layout.
+    BasicMatrix<T> result(a.rows, b.cols);
+    for (size_t i = 0; i < a.rows; ++i) {
+        T* out = result.elements + i * b.cols;
+        for (size_t k = 0; k < a.cols; ++k) {
+            T scale = a(i, k);
+            for (size_t j = 0; j < b.cols; ++j) {
+                multiplyAddOrThrow(out[j], scale, b(k, j));
+            }
+        }
+    }
+    result.detectStructure();
+    result.selectFormat();
+    return result;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixView<T>::divide(const BasicMatrixView& a,
+                                          const BasicMatrixView& b) {
+    if (a.rows != b.rows || a.cols != b.cols) {
+        throw MatrixDimensionMismatchException(
+            "Cannot divide matrices of different dimensions");
+    }
+    BasicMatrix<T> result(a.rows, a.cols);
+    for (size_t i = 0; i < a.rows; ++i) {
+        T* out = result.elements + i * a.cols;
+        for (size_t j = 0; j < a.cols; ++j) {
+            out[j] = divideOrThrow(a(i, j), b(i, j));
+        }
+    }
+    result.detectStructure();
+    result.selectFormat();
+    return result;
+}
+
+template <typename T>
+bool BasicMatrixView<T>::equal(const BasicMatrixView& a,
+                               const BasicMatrixView& b) {
+    if (a.rows != b.rows || a.cols != b.cols) return false;
+    for (size_t i = 0; i < a.rows; ++i) {
+        for (size_t j = 0; j < a.cols; ++j) {
+            if (a(i, j) != b(i, j)) return false;
+        }
+    }
+    return true;
+}
+
+template class BasicMatrixView<float>;
+template class BasicMatrixView<double>;
+template class BasicMatrixView<int64_t>;
+
+template void copyCacheOblivious(const float*, size_t, size_t, float*, size_t,
+                                 size_t, size_t);
+template void copyCacheOblivious(const double*, size_t, size_t, double*,
+                                 size_t, size_t, size_t);
+template void copyCacheOblivious(const int64_t*, size_t, size_t, int64_t*,
+                                 size_t, size_t, size_t);
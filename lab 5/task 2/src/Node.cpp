@@ -1,8 +1,35 @@
 #include "Node.h"
+#include "Telemetry.h"
+#include "Trace.h"
 #include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Forwards each operand as-is, so a temporary lends its buffer to the
+// result through Matrix's rvalue operators.
+template <typename L, typename R>
+Matrix apply(char op, L&& lhs, R&& rhs) {
+    switch (op) {
+        case '+':
+            return std::forward<L>(lhs) + std::forward<R>(rhs);
+        case '-':
+            return std::forward<L>(lhs) - std::forward<R>(rhs);
+        case '*':
+            return std::forward<L>(lhs) * std::forward<R>(rhs);
+        case '/':
+            return std::forward<L>(lhs) / std::forward<R>(rhs);
+        default:
+            throw MatrixArithmeticException("Unknown operator");
+    }
+}
+
+}  // namespace
 
 OperandNode::OperandNode(const Matrix& val) : value(val) {}
 
+OperandNode::OperandNode(Matrix&& val) : value(std::move(val)) {}
+
 bool OperandNode::isOperator() const {
     return false;
 }
@@ -27,6 +54,10 @@ const Matrix& OperandNode::getValue() const {
     return value;
 }
 
+Matrix& OperandNode::getValue() {
+    return value;
+}
+
 OperatorNode::OperatorNode(char oper, std::unique_ptr<Node> lhs, std::unique_ptr<Node> rhs)
     : op(oper), left(std::move(lhs)), right(std::move(rhs)) {}
 
@@ -39,39 +70,52 @@ std::string OperatorNode::toString() const {
 }
 
 std::unique_ptr<Node> OperatorNode::evaluate() {
-    std::unique_ptr<Node> evaluatedLeft = left->evaluate();
-    std::unique_ptr<Node> evaluatedRight = right->evaluate();
-
-    if (!evaluatedLeft || !evaluatedRight) {
+    MATRIX_COUNT(NodeEvaluations, 1);
+    // Covers the children too; a trace viewer nests their own scopes.
+    TraceScope trace(getTraceName());
+
+    // Leaves are read where they stand instead of being copied. An operator
+    // child yields a fresh result that nothing else refers to, so it is
+    // passed on as a temporary.
+    std::unique_ptr<Node> evaluatedLeft;
+    std::unique_ptr<Node> evaluatedRight;
+    if (left->isOperator()) evaluatedLeft = left->evaluate();
+    if (right->isOperator()) evaluatedRight = right->evaluate();
+
+    if ((left->isOperator() && !evaluatedLeft) ||
+        (right->isOperator() && !evaluatedRight)) {
         throw MatrixArithmeticException("Invalid operands for operator " + std::string(1, op));
     }
 
-    const OperandNode* leftOperand = dynamic_cast<OperandNode*>(evaluatedLeft.get());
-    const OperandNode* rightOperand = dynamic_cast<OperandNode*>(evaluatedRight.get());
+    OperandNode* leftOperand = dynamic_cast<OperandNode*>(
+        evaluatedLeft ? evaluatedLeft.get() : left.get());
+    OperandNode* rightOperand = dynamic_cast<OperandNode*>(
+        evaluatedRight ? evaluatedRight.get() : right.get());
 
     if (!leftOperand || !rightOperand) {
         throw MatrixArithmeticException("Operands must be Matrix objects");
     }
 
+    Matrix& lhs = leftOperand->getValue();
+    Matrix& rhs = rightOperand->getValue();
+    // Taken before apply(), which may move either buffer into the result.
+    size_t operandElements =
+        lhs.getRows() * lhs.getCols() + rhs.getRows() * rhs.getCols();
     Matrix result;
-    switch (op) {
-        case '+':
-            result = leftOperand->getValue() + rightOperand->getValue();
-            break;
-        case '-':
-            result = leftOperand->getValue() - rightOperand->getValue();
-            break;
-        case '*':
-            result = leftOperand->getValue() * rightOperand->getValue();
-            break;
-        case '/':
-            result = leftOperand->getValue() / rightOperand->getValue();
-            break;
-        default:
-            throw MatrixArithmeticException("Unknown operator");
+    if (evaluatedLeft && evaluatedRight) {
+        result = apply(op, std::move(lhs), std::move(rhs));
+    } else if (evaluatedLeft) {
+        result = apply(op, std::move(lhs), std::as_const(rhs));
+    } else if (evaluatedRight) {
+        result = apply(op, std::as_const(lhs), std::move(rhs));
+    } else {
+        result = apply(op, std::as_const(lhs), std::as_const(rhs));
     }
 
-    return std::make_unique<OperandNode>(result);
+    size_t elements = operandElements + result.getRows() * result.getCols();
+    trace.describe(result.getRows(), result.getCols(),
+                   elements * sizeof(double));
+    return std::make_unique<OperandNode>(std::move(result));
 }
 
 bool OperatorNode::find(const std::string& target) const {
@@ -87,6 +131,21 @@ char OperatorNode::getOperator() const {
     return op;
 }
 
+const char* OperatorNode::getTraceName() const {
+    switch (op) {
+        case '+':
+            return "OperatorNode +";
+        case '-':
+            return "OperatorNode -";
+        case '*':
+            return "OperatorNode *";
+        case '/':
+            return "OperatorNode /";
+        default:
+            return "OperatorNode";
+    }
+}
+
 Node* OperatorNode::getLeft() const {
     return left.get();
 }
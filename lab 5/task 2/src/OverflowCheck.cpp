@@ -0,0 +1,80 @@
+#include "OverflowCheck.h"
+
+#include <atomic>
+#include <cmath>
+
+#include "MatrixException.h"
+
+static const int DEFERRED_FLAGS = FE_OVERFLOW | FE_DIVBYZERO | FE_INVALID;
+
+static std::atomic<OverflowCheckMode> currentMode{OverflowCheckMode::Strict};
+
+void setOverflowCheckMode(OverflowCheckMode mode) {
+    currentMode.store(mode, std::memory_order_relaxed);
+}
+
+OverflowCheckMode getOverflowCheckMode() {
+    return currentMode.load(std::memory_order_relaxed);
+}
+
+DeferredOverflowCheck::DeferredOverflowCheck()
+    : DeferredOverflowCheck(getOverflowCheckMode()) {}
+
+DeferredOverflowCheck::DeferredOverflowCheck(OverflowCheckMode mode)
+    : mode(mode) {
+    // The unchecked kernel raises flags in either mode; the caller should
+    // not see them, just as it would not in Strict mode.
+    fegetexceptflag(&savedFlags, DEFERRED_FLAGS);
+    if (mode == OverflowCheckMode::FloatingPointStatus) {
+        feclearexcept(DEFERRED_FLAGS);
+    }
+}
+
+DeferredOverflowCheck::~DeferredOverflowCheck() {
+    fesetexceptflag(&savedFlags, DEFERRED_FLAGS);
+}
+
+template <typename T>
+size_t findNonFinite(const T* values, size_t count) {
+    // x - x is 0 for finite x and NaN otherwise, so the sum stays finite
+    // exactly when every value is. The loop has no branch and vectorizes;
+    // the element-by-element search only runs once something was found.
+    T poison = T();
+    for (size_t k = 0; k < count; ++k) {
+        poison += values[k] - values[k];
+    }
+    if (poison == poison) return count;
+
+    for (size_t k = 0; k < count; ++k) {
+        if (!std::isfinite(values[k])) return k;
+    }
+    return count;
+}
+
+template <typename T>
+void DeferredOverflowCheck::finish(const T* values, size_t count,
+                                   const char* overflowMessage,
+                                   const T* divisors) const {
+    bool failed = mode == OverflowCheckMode::FloatingPointStatus
+                      ? fetestexcept(DEFERRED_FLAGS) != 0
+                      : findNonFinite(values, count) != count;
+    if (!failed) return;
+
+    if (divisors) {
+        for (size_t k = 0; k < count; ++k) {
+            if (divisors[k] == T()) {
+                throw MatrixDivisionByZeroException(
+                    "Division by zero in matrix element");
+            }
+        }
+    }
+    throw MatrixOverflowException(overflowMessage);
+}
+
+template size_t findNonFinite(const float*, size_t);
+template size_t findNonFinite(const double*, size_t);
+
+template void DeferredOverflowCheck::finish(const float*, size_t, const char*,
+                                            const float*) const;
+template void DeferredOverflowCheck::finish(const double*, size_t,
+                                            const char*, const double*) const;
@@ -0,0 +1,102 @@
+#include "PackedMatrixBatch.h"
+
+#include <cstdint>
+#include <type_traits>
+
+#include "ElementOps.h"
+#include "MatrixException.h"
+#include "ParallelFor.h"
+
+// Below this many matrices per thread the start-up cost outweighs the work.
+static const size_t MIN_MATRICES_PER_THREAD = 1024;
+
+template <typename T>
+PackedMatrixBatch<T>::PackedMatrixBatch(size_t order, size_t capacity)
+    : order_(order),
+      capacity_(capacity),
+      size_(0),
+      values(order * order * capacity) {}
+
+template <typename T>
+size_t PackedMatrixBatch<T>::lane(size_t row, size_t col) const {
+    return (row * order_ + col) * capacity_;
+}
+
+template <typename T>
+void PackedMatrixBatch<T>::add(const BasicMatrix<T>& matrix) {
+    if (matrix.getRows() != order_ || matrix.getCols() != order_) {
+        throw MatrixDimensionMismatchException(
+            "Matrix does not match the batch order");
+    }
+    if (size_ == capacity_) {
+        throw MatrixException("PackedMatrixBatch is full");
+    }
+    for (size_t i = 0; i < order_; ++i) {
+        for (size_t j = 0; j < order_; ++j) {
+            values[lane(i, j) + size_] = matrix(i, j);
+        }
+    }
+    size_++;
+}
+
+template <typename T>
+size_t PackedMatrixBatch<T>::order() const { return order_; }
+
+template <typename T>
+size_t PackedMatrixBatch<T>::size() const { return size_; }
+
+template <typename T>
+size_t PackedMatrixBatch<T>::capacity() const { return capacity_; }
+
+template <typename T>
+T PackedMatrixBatch<T>::operator()(size_t index, size_t row,
+                                   size_t col) const {
+    if (index >= size_ || row >= order_ || col >= order_) {
+        throw MatrixException("Index out of bounds");
+    }
+    return values[lane(row, col) + index];
+}
+
+template <typename T>
+std::vector<T> PackedMatrixBatch<T>::diagonalProducts(
+    size_t threadCount) const {
+    std::vector<T> mainSums(size_, T());
+    std::vector<T> antiSums(size_, T());
+    std::vector<T> products(size_);
+
+    parallelFor(size_, threadCount, MIN_MATRICES_PER_THREAD,
+                [&](size_t begin, size_t end) {
+        for (size_t i = 0; i < order_; ++i) {
+            const T* diagonal = values.data() + lane(i, i);
+            const T* anti = values.data() + lane(i, order_ - 1 - i);
+            if constexpr (std::is_floating_point<T>::value) {
+                // Unit stride across the batch, no branches: vectorizes.
+                for (size_t m = begin; m < end; ++m) {
+                    mainSums[m] += diagonal[m];
+                    antiSums[m] += anti[m];
+                }
+            } else {
+                for (size_t m = begin; m < end; ++m) {
+                    if (!ElementOps<T>::accumulate(mainSums[m], diagonal[m]) ||
+                        !ElementOps<T>::accumulate(antiSums[m], anti[m])) {
+                        throw MatrixOverflowException(
+                            "Diagonal product overflow");
+                    }
+                }
+            }
+        }
+        for (size_t m = begin; m < end; ++m) {
+            if constexpr (std::is_floating_point<T>::value) {
+                products[m] = mainSums[m] * antiSums[m];
+            } else if (!ElementOps<T>::multiply(mainSums[m], antiSums[m],
+                                                products[m])) {
+                throw MatrixOverflowException("Diagonal product overflow");
+            }
+        }
+    });
+    return products;
+}
+
+template class PackedMatrixBatch<float>;
+template class PackedMatrixBatch<double>;
+template class PackedMatrixBatch<int64_t>;
@@ -0,0 +1,147 @@
+#include "ParallelFileLoader.h"
+#include "MatrixException.h"
+#include "MatrixParser.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+ParallelFileLoader::ParallelFileLoader(const std::string& path, Order order,
+                                       size_t threadCount, size_t chunkBytes)
+    : file(path), order(order) {
+    splitChunks(std::max<size_t>(1, chunkBytes));
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, chunks.size());
+    window = 2 * std::max<size_t>(1, threadCount);
+    for (size_t t = 0; t < threadCount; ++t) {
+        workers.emplace_back(&ParallelFileLoader::work, this);
+    }
+}
+
+ParallelFileLoader::~ParallelFileLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void ParallelFileLoader::splitChunks(size_t chunkBytes) {
+    const char* data = file.data();
+    size_t size = file.size();
+    size_t begin = 0;
+    while (begin < size) {
+        size_t end = std::min(size, begin + chunkBytes);
+        if (end < size) {
+            // Extend to the end of the line the cut fell into.
+            const void* newline = std::memchr(data + end, '\n', size - end);
+            end = newline ? static_cast<const char*>(newline) - data + 1 : size;
+        }
+        chunks.emplace_back(begin, end);
+        begin = end;
+    }
+}
+
+void ParallelFileLoader::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        changed.wait(lock, [this] {
+            return stopping || nextToParse == chunks.size() ||
+                   inFlight < window;
+        });
+        if (stopping || nextToParse == chunks.size()) return;
+        Chunk& chunk = chunks[nextToParse++];
+        inFlight++;
+        lock.unlock();
+
+        std::vector<Matrix> items;
+        std::exception_ptr error;
+        parseChunk(chunk, items, error);
+
+        lock.lock();
+        chunk.items = std::move(items);
+        chunk.error = error;
+        chunk.ready = true;
+        if (order == Order::Any) readyChunks.push_back(&chunk - &chunks[0]);
+        changed.notify_all();
+    }
+}
+
+void ParallelFileLoader::parseChunk(Chunk& chunk, std::vector<Matrix>& items,
+                                    std::exception_ptr& error) const {
+    TraceScope trace("ParallelFileLoader chunk");
+    const char* p = file.data() + chunk.begin;
+    const char* end = file.data() + chunk.end;
+    MATRIX_COUNT(LoaderBytes, chunk.end - chunk.begin);
+    try {
+        while (p != end) {
+            const void* newline = std::memchr(p, '\n', end - p);
+            const char* lineEnd =
+                newline ? static_cast<const char*>(newline) : end;
+            std::string_view line(p, lineEnd - p);
+            p = newline ? lineEnd + 1 : end;
+
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.find_first_not_of(" \t") == std::string_view::npos) {
+                continue;
+            }
+            items.push_back(parseMatrix<double>(line));
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    trace.describe(0, 0, chunk.end - chunk.begin);
+}
+
+ParallelFileLoader::Chunk* ParallelFileLoader::currentChunk(
+    std::unique_lock<std::mutex>& lock) {
+    for (;;) {
+        if (finished == chunks.size()) return nullptr;
+        Chunk* chunk;
+        if (order == Order::Preserve) {
+            chunk = &chunks[finished];
+            changed.wait(lock, [chunk] { return chunk->ready; });
+        } else {
+            changed.wait(lock, [this] { return !readyChunks.empty(); });
+            chunk = &chunks[readyChunks.front()];
+        }
+        if (chunk->taken < chunk->items.size() || chunk->error) return chunk;
+
+        // Used up: free its slot in the window for the workers.
+        std::vector<Matrix>().swap(chunk->items);
+        if (order == Order::Any) readyChunks.pop_front();
+        finished++;
+        inFlight--;
+        changed.notify_all();
+    }
+}
+
+Matrix ParallelFileLoader::GetItem() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (failure) std::rethrow_exception(failure);
+    Chunk* chunk = currentChunk(lock);
+    if (!chunk) {
+        throw MatrixException("ParallelFileLoader has no more items");
+    }
+    if (chunk->taken == chunk->items.size()) {
+        // Nothing after the failing line will be read.
+        failure = chunk->error;
+        stopping = true;
+        changed.notify_all();
+        std::rethrow_exception(failure);
+    }
+    MATRIX_COUNT(LoaderItems, 1);
+    return std::move(chunk->items[chunk->taken++]);
+}
+
+bool ParallelFileLoader::HasNext() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return failure || currentChunk(lock) != nullptr;
+}
+
+bool ParallelFileLoader::CanReadAhead() const { return true; }
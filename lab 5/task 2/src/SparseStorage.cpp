@@ -0,0 +1,38 @@
+#include "SparseStorage.h"
+
+#include <algorithm>
+
+template <typename T>
+SparseStorage<T>::SparseStorage(size_t rows) {
+    rowPtr.reserve(rows + 1);
+    rowPtr.push_back(0);
+}
+
+template <typename T>
+size_t SparseStorage<T>::nonZeros() const { return values.size(); }
+
+template <typename T>
+const T* SparseStorage<T>::find(size_t row, size_t col) const {
+    auto first = colIndex.begin() + rowPtr[row];
+    auto last = colIndex.begin() + rowPtr[row + 1];
+    auto it = std::lower_bound(first, last, col);
+    if (it == last || *it != col) {
+        return nullptr;
+    }
+    return &values[it - colIndex.begin()];
+}
+
+template <typename T>
+void SparseStorage<T>::append(size_t col, T value) {
+    if (value != T()) {
+        colIndex.push_back(col);
+        values.push_back(value);
+    }
+}
+
+template <typename T>
+void SparseStorage<T>::endRow() { rowPtr.push_back(values.size()); }
+
+template struct SparseStorage<float>;
+template struct SparseStorage<double>;
+template struct SparseStorage<int64_t>;
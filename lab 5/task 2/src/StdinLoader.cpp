@@ -0,0 +1,125 @@
+#include "StdinLoader.h"
+#include "MatrixException.h"
+#include "MatrixParser.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STDIN_LOADER_USE_POSIX 1
+#include <unistd.h>
+#endif
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+           c == '\f';
+}
+
+StdinLoader::StdinLoader(int fd)
+    : fd(fd),
+      interactive(false),
+      prompted(false),
+      atEnd(false),
+      buffer(BLOCK_BYTES),
+      begin(0),
+      end(0) {
+#ifdef STDIN_LOADER_USE_POSIX
+    interactive = ::isatty(fd) == 1;
+#endif
+}
+
+// Appends the next block after the unconsumed input; false at end of input.
+bool StdinLoader::fill() {
+    if (atEnd) return false;
+    if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    // A single matrix larger than the buffer grows it.
+    if (buffer.size() - end < BLOCK_BYTES / 2) buffer.resize(2 * buffer.size());
+
+    if (interactive && !prompted) {
+        std::cout << "Enter matrix in format [a,b;c,d]: " << std::flush;
+        prompted = true;
+    }
+
+    for (;;) {
+#ifdef STDIN_LOADER_USE_POSIX
+        ssize_t got = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            throw MatrixException("Unable to read standard input: " +
+                                  std::string(std::strerror(errno)));
+        }
+#else
+        size_t got = std::fread(buffer.data() + end, 1, buffer.size() - end,
+                                stdin);
+        if (got == 0 && std::ferror(stdin)) {
+            throw MatrixException("Unable to read standard input");
+        }
+#endif
+        if (got == 0) {
+            atEnd = true;
+            return false;
+        }
+        end += static_cast<size_t>(got);
+        return true;
+    }
+}
+
+// The next matrix text, from '[' to the matching ']', or the next word if
+// something else comes first so that the parser reports it. Empty at end
+// of input.
+std::string_view StdinLoader::nextToken() {
+    for (;;) {
+        while (begin < end && isBlank(buffer[begin])) begin++;
+        if (begin == end) {
+            if (!fill()) return {};
+            continue;
+        }
+
+        const char* first = buffer.data() + begin;
+        const char* last = buffer.data() + end;
+        const char* stop =
+            *first == '['
+                ? std::find(first, last, ']')
+                : std::find_if(first, last, isBlank);
+        if (stop != last || atEnd) {
+            if (*first == '[' && stop != last) ++stop;
+            std::string_view token(first, stop - first);
+            begin += token.size();
+            return token;
+        }
+        fill();
+    }
+}
+
+Matrix StdinLoader::GetItem() {
+    TraceScope trace("StdinLoader::GetItem");
+    std::string_view token = nextToken();
+    prompted = false;
+    if (token.empty()) {
+        throw MatrixException("StdinLoader has no more items");
+    }
+
+    MATRIX_COUNT(LoaderItems, 1);
+    MATRIX_COUNT(LoaderBytes, token.size());
+    Matrix item = parseMatrix<double>(token);
+    trace.describe(item.getRows(), item.getCols(), token.size());
+    return item;
+}
+
+bool StdinLoader::HasNext() {
+    for (;;) {
+        while (begin < end && isBlank(buffer[begin])) begin++;
+        if (begin < end) return true;
+        if (!fill()) return false;
+    }
+}
+
+bool StdinLoader::CanReadAhead() const { return !interactive; }
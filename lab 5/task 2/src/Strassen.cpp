@@ -0,0 +1,195 @@
+#include "Strassen.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+// Tile edge for blockedMultiply: three 64 x 64 double tiles (96 KiB) stay
+// in L2.
+static const size_t BLOCK_SIZE = 64;
+
+// Strided square block of a row-major matrix.
+template <typename T>
+struct Block {
+    T* data;
+    size_t stride;
+
+    T& at(size_t i, size_t j) const { return data[i * stride + j]; }
+    Block quadrant(size_t qi, size_t qj, size_t half) const {
+        return {data + qi * half * stride + qj * half, stride};
+    }
+};
+
+template <typename T>
+using ConstBlock = Block<const T>;
+
+template <typename T>
+static void multiplyClassical(ConstBlock<T> a, ConstBlock<T> b, Block<T> c,
+                              size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        std::fill(&c.at(i, 0), &c.at(i, 0) + n, T());
+    }
+    for (size_t kk = 0; kk < n; kk += BLOCK_SIZE) {
+        size_t kEnd = std::min(kk + BLOCK_SIZE, n);
+        for (size_t jj = 0; jj < n; jj += BLOCK_SIZE) {
+            size_t jEnd = std::min(jj + BLOCK_SIZE, n);
+            for (size_t i = 0; i < n; ++i) {
+                T* rowC = &c.at(i, 0);
+                for (size_t k = kk; k < kEnd; ++k) {
+                    T scale = a.at(i, k);
+                    const T* rowB = &b.at(k, 0);
+                    for (size_t j = jj; j < jEnd; ++j) {
+                        rowC[j] += scale * rowB[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// out = x + y or out = x - y; out may alias x or y.
+template <typename T>
+static void combine(ConstBlock<T> x, ConstBlock<T> y, Block<T> out, size_t n,
+                    bool subtract) {
+    for (size_t i = 0; i < n; ++i) {
+        const T* rowX = &x.at(i, 0);
+        const T* rowY = &y.at(i, 0);
+        T* rowOut = &out.at(i, 0);
+        if (subtract) {
+            for (size_t j = 0; j < n; ++j) rowOut[j] = rowX[j] - rowY[j];
+        } else {
+            for (size_t j = 0; j < n; ++j) rowOut[j] = rowX[j] + rowY[j];
+        }
+    }
+}
+
+template <typename T>
+static ConstBlock<T> asConst(Block<T> block) {
+    return {block.data, block.stride};
+}
+
+template <typename T>
+static void multiplyRecursive(ConstBlock<T> a, ConstBlock<T> b, Block<T> c,
+                              size_t n, T* scratch);
+
+// Fixes up the last row and column of an odd-order product whose leading
+// (n-1) x (n-1) block already holds A11 * B11.
+template <typename T>
+static void peelOdd(ConstBlock<T> a, ConstBlock<T> b, Block<T> c, size_t n) {
+    size_t m = n - 1;
+    // C11 += a12 * b21 (rank-one update).
+    for (size_t i = 0; i < m; ++i) {
+        T scale = a.at(i, m);
+        T* rowC = &c.at(i, 0);
+        const T* rowB = &b.at(m, 0);
+        for (size_t j = 0; j < m; ++j) rowC[j] += scale * rowB[j];
+    }
+    // Last column: C(:, m) = A * b(:, m).
+    for (size_t i = 0; i < n; ++i) {
+        T sum = T();
+        for (size_t k = 0; k < n; ++k) sum += a.at(i, k) * b.at(k, m);
+        c.at(i, m) = sum;
+    }
+    // Last row: C(m, 0..m) = a(m, :) * B(:, 0..m).
+    T* rowC = &c.at(m, 0);
+    std::fill(rowC, rowC + m, T());
+    for (size_t k = 0; k < n; ++k) {
+        T scale = a.at(m, k);
+        const T* rowB = &b.at(k, 0);
+        for (size_t j = 0; j < m; ++j) rowC[j] += scale * rowB[j];
+    }
+}
+
+template <typename T>
+static void multiplyRecursive(ConstBlock<T> a, ConstBlock<T> b, Block<T> c,
+                              size_t n, T* scratch) {
+    if (n <= STRASSEN_CUTOFF) {
+        multiplyClassical(a, b, c, n);
+        return;
+    }
+    if (n % 2 == 1) {
+        multiplyRecursive(a, b, c, n - 1, scratch);
+        peelOdd(a, b, c, n);
+        return;
+    }
+
+    size_t h = n / 2;
+    ConstBlock<T> a11 = a.quadrant(0, 0, h), a12 = a.quadrant(0, 1, h);
+    ConstBlock<T> a21 = a.quadrant(1, 0, h), a22 = a.quadrant(1, 1, h);
+    ConstBlock<T> b11 = b.quadrant(0, 0, h), b12 = b.quadrant(0, 1, h);
+    ConstBlock<T> b21 = b.quadrant(1, 0, h), b22 = b.quadrant(1, 1, h);
+    Block<T> c11 = c.quadrant(0, 0, h), c12 = c.quadrant(0, 1, h);
+    Block<T> c21 = c.quadrant(1, 0, h), c22 = c.quadrant(1, 1, h);
+
+    // Two h x h temporaries per level; the quadrants of C hold the rest.
+    // Schedule from Boyer, Dumas, Pernet and Zhou, "Memory efficient
+    // scheduling of Strassen-Winograd's matrix multiplication algorithm"
+    // (ISSAC 2009), table 1.
+    Block<T> x{scratch, h};
+    Block<T> y{scratch + h * h, h};
+    T* deeper = scratch + 2 * h * h;
+
+    combine(a11, a21, x, h, true);                               // S3
+    combine(b22, b12, y, h, true);                               // T3
+    multiplyRecursive(asConst(x), asConst(y), c21, h, deeper);   // P7
+    combine(a21, a22, x, h, false);                              // S1
+    combine(b12, b11, y, h, true);                               // T1
+    multiplyRecursive(asConst(x), asConst(y), c22, h, deeper);   // P5
+    combine(asConst(x), a11, x, h, true);                        // S2
+    combine(b22, asConst(y), y, h, true);                        // T2
+    multiplyRecursive(asConst(x), asConst(y), c12, h, deeper);   // P6
+    combine(a12, asConst(x), x, h, true);                        // S4
+    multiplyRecursive(asConst(x), b22, c11, h, deeper);          // P3
+    multiplyRecursive(a11, b11, x, h, deeper);                   // P1
+    combine(asConst(x), asConst(c12), c12, h, false);            // U2
+    combine(asConst(c12), asConst(c21), c21, h, false);          // U3
+    combine(asConst(c12), asConst(c22), c12, h, false);          // U4
+    combine(asConst(c21), asConst(c22), c22, h, false);          // U7 = C22
+    combine(asConst(c12), asConst(c11), c12, h, false);          // U5 = C12
+    combine(asConst(y), b21, y, h, true);                        // T4
+    multiplyRecursive(a22, asConst(y), c11, h, deeper);          // P4
+    combine(asConst(c21), asConst(c11), c21, h, true);           // U6 = C21
+    multiplyRecursive(a12, b21, c11, h, deeper);                 // P2
+    combine(asConst(x), asConst(c11), c11, h, false);            // U1 = C11
+}
+
+// 2 h^2 per level with h halving each time: 2 (n/2)^2 (1 + 1/4 + ...).
+static size_t scratchSize(size_t n) {
+    size_t total = 0;
+    while (n > STRASSEN_CUTOFF) {
+        n -= n % 2;
+        n /= 2;
+        total += 2 * n * n;
+    }
+    return total;
+}
+
+double strassenGrowthBound(size_t n) {
+    double bound = 2.0 * n;
+    while (n > STRASSEN_CUTOFF) {
+        n -= n % 2;
+        n /= 2;
+        bound *= 64;
+    }
+    return bound;
+}
+
+template <typename T>
+void blockedMultiply(const T* a, const T* b, T* c, size_t n) {
+    multiplyClassical<T>({a, n}, {b, n}, {c, n}, n);
+}
+
+template <typename T>
+void strassenMultiply(const T* a, const T* b, T* c, size_t n) {
+    std::unique_ptr<T[]> scratch(new T[scratchSize(n)]);
+    multiplyRecursive<T>({a, n}, {b, n}, {c, n}, n, scratch.get());
+}
+
+template void blockedMultiply(const float*, const float*, float*, size_t);
+template void blockedMultiply(const double*, const double*, double*, size_t);
+template void blockedMultiply(const int64_t*, const int64_t*, int64_t*,
+                              size_t);
+
+template void strassenMultiply(const float*, const float*, float*, size_t);
+template void strassenMultiply(const double*, const double*, double*,
+                               size_t);
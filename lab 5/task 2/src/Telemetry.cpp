@@ -0,0 +1,83 @@
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<TelemetryShard*> shards;
+    uint64_t exited[COUNTER_COUNT] = {};
+};
+
+Registry& registry() {
+    // Never destroyed: threads may still exit after static destruction.
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+    "matrix_allocations",       "matrix_bytes",
+    "multiply_flops",           "strict_overflow_checks",
+    "deferred_overflow_checks", "node_evaluations",
+    "loader_items",             "loader_bytes",
+    "sorts",                    "sort_comparisons",
+};
+
+}  // namespace
+
+const char* counterName(Counter counter) {
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+TelemetryRegistration::TelemetryRegistration(TelemetryShard& shard)
+    : shard(shard) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.shards.push_back(&shard);
+}
+
+TelemetryRegistration::~TelemetryRegistration() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        r.exited[c] += shard.values[c].load(std::memory_order_relaxed);
+    }
+    r.shards.erase(std::find(r.shards.begin(), r.shards.end(), &shard));
+}
+
+TelemetrySnapshot TelemetrySnapshot::take() {
+    TelemetrySnapshot snapshot;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        snapshot.values[c] = r.exited[c];
+        for (const TelemetryShard* shard : r.shards) {
+            snapshot.values[c] +=
+                shard->values[c].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+TelemetrySnapshot TelemetrySnapshot::operator-(
+    const TelemetrySnapshot& earlier) const {
+    TelemetrySnapshot difference;
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        difference.values[c] = values[c] - earlier.values[c];
+    }
+    return difference;
+}
+
+std::string TelemetrySnapshot::toText() const {
+    std::string text;
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        text += counterName(static_cast<Counter>(c));
+        text += ' ';
+        text += std::to_string(values[c]);
+        text += '\n';
+    }
+    return text;
+}
@@ -0,0 +1,54 @@
+#include "TopKSelector.h"
+
+#include <algorithm>
+#include <utility>
+
+TopKSelector::TopKSelector(size_t k,
+                           const IComparer<ArithmeticExpression>& comp)
+    : limit(k), comparer(comp) {}
+
+bool TopKSelector::less(const ArithmeticExpression& a,
+                        const ArithmeticExpression& b) const {
+    return comparer.Compare(a, b) < 0;
+}
+
+bool TopKSelector::add(ArithmeticExpression&& expr) {
+    auto cmp = [this](const ArithmeticExpression& a,
+                      const ArithmeticExpression& b) -> bool {
+        return less(a, b);
+    };
+
+    if (heap.size() < limit) {
+        heap.push_back(std::move(expr));
+        std::push_heap(heap.begin(), heap.end(), cmp);
+        return true;
+    }
+
+    if (limit == 0 || !less(expr, heap[0])) {
+        return false;
+    }
+
+    std::pop_heap(heap.begin(), heap.end(), cmp);
+    heap.back() = std::move(expr);
+    std::push_heap(heap.begin(), heap.end(), cmp);
+    return true;
+}
+
+size_t TopKSelector::size() const { return heap.size(); }
+
+size_t TopKSelector::k() const { return limit; }
+
+VectorAnalog TopKSelector::release() {
+    auto cmp = [this](const ArithmeticExpression& a,
+                      const ArithmeticExpression& b) -> bool {
+        return less(a, b);
+    };
+    std::sort_heap(heap.begin(), heap.end(), cmp);
+
+    VectorAnalog result;
+    for (ArithmeticExpression& expr : heap) {
+        result.add(std::move(expr));
+    }
+    heap.clear();
+    return result;
+}
@@ -0,0 +1,191 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MatrixException.h"
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t bytes;
+};
+
+// Written only by the thread holding it. head counts every event ever
+// recorded; the newest TRACE_RING_CAPACITY of them are in
+// events[index % capacity].
+struct TraceRing {
+    std::atomic<uint64_t> head{0};
+    size_t threadId;
+    TraceEvent events[TRACE_RING_CAPACITY];
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    // Rings outlive their threads so that a trace can be written later.
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    // Rings whose thread has exited. The next new thread carries on in one
+    // of them, so there are only as many rings as threads ever traced at
+    // once, however many short-lived workers come and go.
+    std::vector<TraceRing*> idle;
+};
+
+std::atomic<bool> tracing{false};
+
+TraceRegistry& registry() {
+    // Never destroyed: threads may still exit after static destruction.
+    static TraceRegistry* instance = new TraceRegistry();
+    return *instance;
+}
+
+// Hands the calling thread's ring back to the registry as it exits.
+struct RingLease {
+    TraceRing*& ring;
+
+    explicit RingLease(TraceRing*& ring) : ring(ring) {}
+
+    ~RingLease() {
+        TraceRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.idle.push_back(ring);
+        ring = nullptr;
+    }
+};
+
+TraceRing& localRing() {
+    thread_local TraceRing* ring = nullptr;
+    if (!ring) {
+        TraceRegistry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (!r.idle.empty()) {
+                // Keeps the earlier thread's id and events; their spans
+                // never overlap this thread's in time.
+                ring = r.idle.back();
+                r.idle.pop_back();
+            } else {
+                r.rings.push_back(std::make_unique<TraceRing>());
+                ring = r.rings.back().get();
+                ring->threadId = r.rings.size();
+            }
+        }
+        thread_local RingLease lease(ring);
+    }
+    return *ring;
+}
+
+uint64_t nowNs() {
+    static const std::chrono::steady_clock::time_point epoch =
+        std::chrono::steady_clock::now();
+    // Offset by one so that a recorded start is never 0.
+    return 1 + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - epoch)
+                   .count();
+}
+
+void record(const TraceEvent& event) {
+    TraceRing& ring = localRing();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.events[head % TRACE_RING_CAPACITY] = event;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+// Copies out the events of ring that are still intact.
+std::vector<TraceEvent> readRing(const TraceRing& ring) {
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = head > TRACE_RING_CAPACITY ? head - TRACE_RING_CAPACITY
+                                                : 0;
+    std::vector<TraceEvent> events;
+    events.reserve(head - first);
+    for (uint64_t i = first; i < head; ++i) {
+        events.push_back(ring.events[i % TRACE_RING_CAPACITY]);
+    }
+    // Anything the writer has lapped since may be torn.
+    uint64_t after = ring.head.load(std::memory_order_acquire);
+    if (after > TRACE_RING_CAPACITY && after - TRACE_RING_CAPACITY > first) {
+        size_t lost = std::min<uint64_t>(after - TRACE_RING_CAPACITY - first,
+                                         events.size());
+        events.erase(events.begin(), events.begin() + lost);
+    }
+    return events;
+}
+
+}  // namespace
+
+void setTracingEnabled(bool enabled) {
+    if (enabled) nowNs();
+    tracing.store(enabled, std::memory_order_relaxed);
+}
+
+bool isTracingEnabled() { return tracing.load(std::memory_order_relaxed); }
+
+void writeChromeTrace(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        throw MatrixException("Unable to open file: " + path);
+    }
+
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+    bool first = true;
+    for (const std::unique_ptr<TraceRing>& ring : r.rings) {
+        std::fprintf(file,
+                     "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                     "\"tid\":%zu,\"args\":{\"name\":\"thread %zu\"}}",
+                     first ? "" : ",", ring->threadId, ring->threadId);
+        first = false;
+        for (const TraceEvent& event : readRing(*ring)) {
+            // Complete events; Chrome expects microseconds.
+            std::fprintf(
+                file,
+                ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,"
+                "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"rows\":%llu,"
+                "\"cols\":%llu,\"bytes\":%llu}}",
+                event.name, ring->threadId, event.startNs / 1000.0,
+                (event.endNs - event.startNs) / 1000.0,
+                static_cast<unsigned long long>(event.rows),
+                static_cast<unsigned long long>(event.cols),
+                static_cast<unsigned long long>(event.bytes));
+        }
+    }
+    std::fputs("\n]}\n", file);
+    if (std::fclose(file) != 0) {
+        throw MatrixException("Unable to write file: " + path);
+    }
+}
+
+void clearTrace() {
+    TraceRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<TraceRing>& ring : r.rings) {
+        ring->head.store(0, std::memory_order_relaxed);
+    }
+}
+
+TraceScope::TraceScope(const char* name)
+    : name(name),
+      startNs(isTracingEnabled() ? nowNs() : 0),
+      rows(0),
+      cols(0),
+      bytes(0) {}
+
+TraceScope::~TraceScope() {
+    if (startNs) record({name, startNs, nowNs(), rows, cols, bytes});
+}
+
+void TraceScope::describe(size_t rows, size_t cols, uint64_t bytes) {
+    this->rows = rows;
+    this->cols = cols;
+    this->bytes = bytes;
+}
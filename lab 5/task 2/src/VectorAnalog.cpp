@@ -1,12 +1,124 @@
 #include "VectorAnalog.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <utility>
+#include <vector>
 
+#include "MappedFile.h"
 #include "MatrixException.h"
+#include "Node.h"
+#include "Telemetry.h"
 
 const size_t INITIAL_CAPACITY = 4;
 
+namespace {
+
+// Snapshot layout (native endianness, every section 8-byte aligned):
+//   SnapshotHeader
+//   SnapshotExpression[expressionCount]  - slice of the node table
+//   SnapshotNode[nodeCount]              - post-order, per expression
+//   SnapshotMatrix[matrixCount]          - shape and offset into values
+//   double[valueCount]                   - row-major operand values
+const char SNAPSHOT_MAGIC[8] = {'V', 'A', 'S', 'N', 'A', 'P', '0', '1'};
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+const uint8_t NODE_OPERAND = 0;
+const uint8_t NODE_OPERATOR = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t expressionCount;
+    uint64_t nodeCount;
+    uint64_t matrixCount;
+    uint64_t valueCount;
+};
+
+struct SnapshotExpression {
+    uint64_t firstNode;
+    uint64_t nodeCount;
+};
+
+struct SnapshotNode {
+    uint8_t kind;
+    char op;
+    uint8_t reserved[6];
+    uint64_t matrix;
+};
+
+struct SnapshotMatrix {
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t offset;
+};
+
+bool isSnapshotOperator(char op) {
+    return op == '+' || op == '-' || op == '*' || op == '/';
+}
+
+// Returns the offset of a section of count records that starts at next, and
+// moves next past it. The count is checked against the bytes left before it
+// is multiplied, so a corrupt header cannot wrap the offsets around.
+size_t takeSection(size_t& next, size_t fileSize, uint64_t count,
+                   size_t recordSize) {
+    if (next > fileSize || count > (fileSize - next) / recordSize) {
+        throw MatrixException("Invalid snapshot: file is truncated");
+    }
+    size_t at = next;
+    next += count * recordSize;
+    return at;
+}
+
+void appendPostOrder(const Node* root, std::vector<SnapshotNode>& nodes,
+                     std::vector<SnapshotMatrix>& matrices,
+                     std::vector<const Matrix*>& operands,
+                     uint64_t& valueCount) {
+    std::vector<std::pair<const Node*, bool>> stack;
+    stack.emplace_back(root, false);
+
+    while (!stack.empty()) {
+        const Node* current = stack.back().first;
+        bool expanded = stack.back().second;
+        stack.pop_back();
+
+        SnapshotNode record = {};
+        if (!current->isOperator()) {
+            const Matrix& value =
+                static_cast<const OperandNode*>(current)->getValue();
+            record.kind = NODE_OPERAND;
+            record.matrix = matrices.size();
+            matrices.push_back({value.getRows(), value.getCols(), valueCount});
+            operands.push_back(&value);
+            valueCount += value.getRows() * value.getCols();
+            nodes.push_back(record);
+        } else if (expanded) {
+            record.kind = NODE_OPERATOR;
+            record.op =
+                static_cast<const OperatorNode*>(current)->getOperator();
+            nodes.push_back(record);
+        } else {
+            const OperatorNode* opNode =
+                static_cast<const OperatorNode*>(current);
+            stack.emplace_back(current, true);
+            stack.emplace_back(opNode->getRight(), false);
+            stack.emplace_back(opNode->getLeft(), false);
+        }
+    }
+}
+
+template <typename T>
+void writeRecords(std::ofstream& out, const std::vector<T>& records) {
+    out.write(reinterpret_cast<const char*>(records.data()),
+              records.size() * sizeof(T));
+}
+
+}  // namespace
+
 VectorAnalog::VectorAnalog() : data(nullptr), capacity(0), size_(0) {
     capacity = INITIAL_CAPACITY;
     data = std::make_unique<ArithmeticExpression[]>(capacity);
@@ -48,6 +160,12 @@ void VectorAnalog::add(ArithmeticExpression&& expr) {
     size_++;
 }
 
+void VectorAnalog::reserve(size_t new_capacity) {
+    if (new_capacity > capacity) {
+        resize(new_capacity);
+    }
+}
+
 void VectorAnalog::remove(size_t index) {
     if (index >= size_) {
         throw MatrixException("Index out of bounds in VectorAnalog::remove");
@@ -90,7 +208,207 @@ void VectorAnalog::printAll() const {
 }
 
 void VectorAnalog::sort(const IComparer<ArithmeticExpression>& comparer) {
+    MATRIX_COUNT(Sorts, 1);
     std::sort(data.get(), data.get() + size_,
               [&](const ArithmeticExpression& a, const ArithmeticExpression& b)
-                  -> bool { return comparer.Compare(a, b) < 0; });
+                  -> bool {
+                  MATRIX_COUNT(SortComparisons, 1);
+                  return comparer.Compare(a, b) < 0;
+              });
+}
+
+void VectorAnalog::sortByKeys(
+    const std::vector<double>& keys,
+    const IComparer<ArithmeticExpression>* tieBreaker) {
+    if (keys.size() != size_) {
+        throw MatrixException("Key count does not match VectorAnalog size");
+    }
+
+    MATRIX_COUNT(Sorts, 1);
+    std::vector<size_t> order(size_);
+    for (size_t i = 0; i < size_; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        MATRIX_COUNT(SortComparisons, 1);
+        if (keys[a] != keys[b]) return keys[a] < keys[b];
+        return tieBreaker && tieBreaker->Compare(data[a], data[b]) < 0;
+    });
+
+    std::unique_ptr<ArithmeticExpression[]> sorted(
+        new ArithmeticExpression[capacity]);
+    for (size_t i = 0; i < size_; ++i) {
+        sorted[i] = std::move(data[order[i]]);
+    }
+    data = std::move(sorted);
+}
+
+void VectorAnalog::partialSort(
+    size_t k, const IComparer<ArithmeticExpression>& comparer) {
+    k = std::min(k, size_);
+    MATRIX_COUNT(Sorts, 1);
+    std::partial_sort(
+        data.get(), data.get() + k, data.get() + size_,
+        [&](const ArithmeticExpression& a, const ArithmeticExpression& b)
+            -> bool {
+            MATRIX_COUNT(SortComparisons, 1);
+            return comparer.Compare(a, b) < 0;
+        });
+}
+
+void VectorAnalog::nthElement(
+    size_t k, const IComparer<ArithmeticExpression>& comparer) {
+    if (size_ == 0) return;
+    k = std::min(k, size_ - 1);
+    MATRIX_COUNT(Sorts, 1);
+    std::nth_element(
+        data.get(), data.get() + k, data.get() + size_,
+        [&](const ArithmeticExpression& a, const ArithmeticExpression& b)
+            -> bool {
+            MATRIX_COUNT(SortComparisons, 1);
+            return comparer.Compare(a, b) < 0;
+        });
+}
+
+void VectorAnalog::saveSnapshot(const std::string& path) const {
+    std::vector<SnapshotExpression> expressions;
+    std::vector<SnapshotNode> nodes;
+    std::vector<SnapshotMatrix> matrices;
+    std::vector<const Matrix*> operands;
+    uint64_t valueCount = 0;
+
+    expressions.reserve(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        uint64_t first = nodes.size();
+        const Node* root = data[i].getRoot();
+        if (root) {
+            appendPostOrder(root, nodes, matrices, operands, valueCount);
+        }
+        expressions.push_back({first, nodes.size() - first});
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.expressionCount = expressions.size();
+    header.nodeCount = nodes.size();
+    header.matrixCount = matrices.size();
+    header.valueCount = valueCount;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw MatrixException("Unable to open file: " + path);
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeRecords(out, expressions);
+    writeRecords(out, nodes);
+    writeRecords(out, matrices);
+
+    std::vector<double> row;
+    for (const Matrix* operand : operands) {
+        row.resize(operand->getCols());
+        for (size_t r = 0; r < operand->getRows(); ++r) {
+            for (size_t c = 0; c < operand->getCols(); ++c) {
+                row[c] = (*operand)(r, c);
+            }
+            writeRecords(out, row);
+        }
+    }
+
+    if (!out) {
+        throw MatrixException("Failed to write snapshot: " + path);
+    }
+}
+
+void VectorAnalog::loadSnapshot(const std::string& path) {
+    MappedFile file(path);
+    const char* bytes = file.data();
+
+    SnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        throw MatrixException("Invalid snapshot: file is truncated");
+    }
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION ||
+        header.byteOrder != SNAPSHOT_BYTE_ORDER) {
+        throw MatrixException("Invalid snapshot: unsupported format");
+    }
+
+    size_t next = sizeof(header);
+    size_t expressionsAt = takeSection(next, file.size(),
+                                       header.expressionCount,
+                                       sizeof(SnapshotExpression));
+    size_t nodesAt = takeSection(next, file.size(), header.nodeCount,
+                                 sizeof(SnapshotNode));
+    size_t matricesAt = takeSection(next, file.size(), header.matrixCount,
+                                    sizeof(SnapshotMatrix));
+    size_t valuesAt =
+        takeSection(next, file.size(), header.valueCount, sizeof(double));
+
+    // Every section starts on an 8-byte boundary of a page-aligned mapping,
+    // so the tables are read in place.
+    const SnapshotExpression* expressions =
+        reinterpret_cast<const SnapshotExpression*>(bytes + expressionsAt);
+    const SnapshotNode* nodes =
+        reinterpret_cast<const SnapshotNode*>(bytes + nodesAt);
+    const SnapshotMatrix* matrices =
+        reinterpret_cast<const SnapshotMatrix*>(bytes + matricesAt);
+    const double* values = reinterpret_cast<const double*>(bytes + valuesAt);
+
+    VectorAnalog restored;
+    restored.reserve(header.expressionCount);
+
+    std::vector<std::unique_ptr<Node>> stack;
+    for (uint64_t e = 0; e < header.expressionCount; ++e) {
+        const SnapshotExpression& expr = expressions[e];
+        if (expr.firstNode > header.nodeCount ||
+            expr.nodeCount > header.nodeCount - expr.firstNode) {
+            throw MatrixException("Invalid snapshot: node range out of bounds");
+        }
+
+        stack.clear();
+        for (uint64_t n = 0; n < expr.nodeCount; ++n) {
+            const SnapshotNode& node = nodes[expr.firstNode + n];
+            if (node.kind == NODE_OPERAND) {
+                if (node.matrix >= header.matrixCount) {
+                    throw MatrixException(
+                        "Invalid snapshot: operand index out of bounds");
+                }
+                const SnapshotMatrix& m = matrices[node.matrix];
+                if (m.offset > header.valueCount ||
+                    (m.rows != 0 &&
+                     m.cols > (header.valueCount - m.offset) / m.rows)) {
+                    throw MatrixException(
+                        "Invalid snapshot: operand values out of bounds");
+                }
+                stack.push_back(std::make_unique<OperandNode>(
+                    Matrix(values + m.offset, m.rows, m.cols)));
+            } else {
+                if (node.kind != NODE_OPERATOR ||
+                    !isSnapshotOperator(node.op)) {
+                    throw MatrixException(
+                        "Invalid snapshot: unknown node kind or operator");
+                }
+                if (stack.size() < 2) {
+                    throw MatrixException(
+                        "Invalid snapshot: operator is missing operands");
+                }
+                std::unique_ptr<Node> right = std::move(stack.back());
+                stack.pop_back();
+                std::unique_ptr<Node> left = std::move(stack.back());
+                stack.pop_back();
+                stack.push_back(std::make_unique<OperatorNode>(
+                    node.op, std::move(left), std::move(right)));
+            }
+        }
+
+        if (stack.size() > 1) {
+            throw MatrixException("Invalid snapshot: malformed expression");
+        }
+        restored.add(ArithmeticExpression(
+            stack.empty() ? nullptr : std::move(stack.back())));
+    }
+
+    *this = std::move(restored);
 }
@@ -75,9 +75,8 @@ int main() {
             std::cout << "Вираз B: " << exprB_ref.PrintExpression()
                       << std::endl;
 
-            std::vector<Matrix*> operands = exprB_ref.getOperands();
-            for (const auto& mat_ptr : operands) {
-                std::cout << mat_ptr->toString() << std::endl;
+            for (const Matrix& operand : exprB_ref) {
+                std::cout << operand.toString() << std::endl;
             }
         } else {
             std::cerr << "Вираз B не знайдений у контейнері." << std::endl;
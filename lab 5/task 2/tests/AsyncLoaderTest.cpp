@@ -0,0 +1,141 @@
+// AsyncLoader hands items over in the wrapped loader's order at every
+// capacity, whichever side is slower; an error is rethrown at its own
+// position and by every call after it, and nothing past it is read.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "AsyncLoader.h"
+#include "Loader.h"
+#include "MatrixException.h"
+#include "TestSupport.h"
+
+// Yields 1x1 matrices 0, 1, ..., count - 1, throwing instead at failAt.
+class SequenceLoader : public Loader {
+private:
+    int count;
+    int failAt;
+    std::chrono::microseconds delay;
+    std::shared_ptr<std::atomic<int>> reads;
+    int next = 0;
+
+public:
+    SequenceLoader(int count, int failAt = -1,
+                   std::chrono::microseconds delay = {},
+                   std::shared_ptr<std::atomic<int>> reads =
+                       std::make_shared<std::atomic<int>>(0))
+        : count(count), failAt(failAt), delay(delay), reads(reads) {}
+
+    Matrix GetItem() override {
+        ++*reads;
+        std::this_thread::sleep_for(delay);
+        int value = next++;
+        if (value == failAt) {
+            throw MatrixOverflowException("item " + std::to_string(value));
+        }
+        Matrix item(1, 1);
+        item(0, 0) = value;
+        return item;
+    }
+    bool HasNext() override { return next < count; }
+    bool CanReadAhead() const override { return true; }
+};
+
+static int valueOf(const Matrix& item) {
+    return static_cast<int>(item(0, 0));
+}
+
+// Reads everything, checking the order; returns the number of items.
+static int drain(Loader& loader, std::chrono::microseconds work = {}) {
+    int count = 0;
+    while (loader.HasNext()) {
+        if (valueOf(loader.GetItem()) != count) return -1;
+        ++count;
+        std::this_thread::sleep_for(work);
+    }
+    return count;
+}
+
+int main() {
+    using std::chrono::microseconds;
+
+    // Ordering with a fast reader (the ring fills up), a slow one (the
+    // consumer waits) and neither.
+    for (size_t capacity : {1, 2, 4, 64}) {
+        AsyncLoader plain(std::make_unique<SequenceLoader>(300), capacity);
+        CHECK(drain(plain) == 300);
+
+        AsyncLoader slowConsumer(std::make_unique<SequenceLoader>(40),
+                                 capacity);
+        CHECK(drain(slowConsumer, microseconds(500)) == 40);
+
+        AsyncLoader slowReader(
+            std::make_unique<SequenceLoader>(40, -1, microseconds(500)),
+            capacity);
+        CHECK(drain(slowReader) == 40);
+
+        // At the end HasNext() turns false and GetItem() throws.
+        CHECK(!plain.HasNext());
+        CHECK(contains(exceptionMessage([&] { plain.GetItem(); }),
+                       "no more items"));
+    }
+
+    // An error comes out at its position: every item before it in order,
+    // then the wrapped loader's own exception, again on every later call.
+    for (size_t capacity : {1, 3, 16}) {
+        for (int failAt : {0, 5}) {
+            auto reads = std::make_shared<std::atomic<int>>(0);
+            {
+                AsyncLoader loader(std::make_unique<SequenceLoader>(
+                                       100, failAt, microseconds(0), reads),
+                                   capacity);
+                for (int k = 0; k < failAt; ++k) {
+                    CHECK(valueOf(loader.GetItem()) == k);
+                }
+                for (int repeat = 0; repeat < 3; ++repeat) {
+                    bool thrown = false;
+                    try {
+                        loader.GetItem();
+                    } catch (const MatrixOverflowException& e) {
+                        thrown = e.what() ==
+                                 "Matrix overflow: item " +
+                                     std::to_string(failAt);
+                    }
+                    CHECK(thrown);
+                }
+            }
+            // Reading stopped at the failure even though the ring had
+            // room for more.
+            CHECK(reads->load() == failAt + 1);
+        }
+    }
+
+    // An AsyncLoader can read ahead itself, so it can be stacked.
+    AsyncLoader stacked(std::make_unique<AsyncLoader>(
+        std::make_unique<SequenceLoader>(50), 2));
+    CHECK(drain(stacked) == 50);
+
+    // Destruction while the reader waits on a full ring, or before
+    // anything was read.
+    {
+        AsyncLoader full(std::make_unique<SequenceLoader>(1000), 2);
+        CHECK(valueOf(full.GetItem()) == 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    { AsyncLoader untouched(std::make_unique<SequenceLoader>(1000)); }
+
+    // Loaders that never run dry or that prompt are refused.
+    CHECK(!exceptionMessage([] {
+               AsyncLoader loader(std::make_unique<ConsoleLoader>());
+           }).empty());
+    CHECK(!exceptionMessage([] {
+               AsyncLoader loader(
+                   std::make_unique<FileLoader>("AsyncLoaderTest.txt"));
+           }).empty());
+    CHECK(!exceptionMessage([] { AsyncLoader loader(nullptr); }).empty());
+
+    return testResult();
+}
@@ -0,0 +1,90 @@
+// ConcurrentVectorAnalog under contention: many threads add at once, each
+// reads its own elements back while the others keep growing the segment
+// table, and every expression must end up stored exactly once.
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ArithmeticExpression.h"
+#include "ConcurrentVectorAnalog.h"
+#include "Node.h"
+#include "TestSupport.h"
+#include "VectorAnalog.h"
+
+static const int THREADS = 8;
+static const int ADDS_PER_THREAD = 3000;
+
+static ArithmeticExpression expressionOf(int value) {
+    Matrix matrix(1, 1);
+    matrix(0, 0) = value;
+    return ArithmeticExpression(std::make_unique<OperandNode>(matrix));
+}
+
+static int valueOf(ArithmeticExpression& expr) {
+    const Matrix result = expr.Evaluate();
+    return static_cast<int>(result(0, 0));
+}
+
+int main() {
+    ConcurrentVectorAnalog container;
+
+    // Segments never move, so this reference must survive all the growth
+    // below.
+    size_t firstIndex = container.add(expressionOf(-1));
+    ArithmeticExpression* first = &container[firstIndex];
+
+    std::atomic<bool> start(false);
+    std::atomic<int> misreads(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < ADDS_PER_THREAD; ++i) {
+                int value = t * ADDS_PER_THREAD + i;
+                size_t index = container.add(expressionOf(value));
+                if (valueOf(container[index]) != value) ++misreads;
+            }
+        });
+    }
+    start.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) thread.join();
+
+    const size_t total = size_t(THREADS) * ADDS_PER_THREAD + 1;
+    CHECK(misreads.load() == 0);
+    CHECK(container.size() == total);
+    CHECK(&container[firstIndex] == first);
+    CHECK(valueOf(*first) == -1);
+
+    VectorAnalog frozen = container.freeze();
+    CHECK(container.size() == 0);
+    CHECK(frozen.size() == total);
+
+    std::vector<int> seen(size_t(THREADS) * ADDS_PER_THREAD, 0);
+    int outOfRange = 0;
+    for (size_t i = 0; i < frozen.size(); ++i) {
+        int value = valueOf(frozen[i]);
+        if (value == -1) continue;
+        if (value < 0 || static_cast<size_t>(value) >= seen.size()) {
+            ++outOfRange;
+            continue;
+        }
+        ++seen[value];
+    }
+    CHECK(outOfRange == 0);
+    int notOnce = 0;
+    for (int count : seen) {
+        if (count != 1) ++notOnce;
+    }
+    CHECK(notOnce == 0);
+
+    // The container is usable again after freeze().
+    CHECK(container.add(expressionOf(7)) == 0);
+    CHECK(valueOf(container[0]) == 7);
+
+    return testResult();
+}
@@ -0,0 +1,163 @@
+// MatrixArchiveWriter / MatrixArchiveLoader: matrices come back by id and
+// in sequence exactly as appended, and truncated or corrupt archives are
+// rejected with MatrixException. Offsets below follow the layout described
+// in src/MatrixArchive.cpp.
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "MatrixArchive.h"
+#include "TestSupport.h"
+
+static const char* ARCHIVE = "MatrixArchiveTest.mxa";
+static const char* SMALL = "MatrixArchiveTest.small.mxa";
+static const char* DAMAGED = "MatrixArchiveTest.damaged.mxa";
+
+static const size_t HEADER_SIZE = 16;
+static const size_t ENTRY_SIZE = 32;
+static const size_t FOOTER_SIZE = 24;
+
+static const int COUNT = 2000;
+
+// Shapes from 1x1 to 5x6, values that differ per id.
+static Matrix sample(int id) {
+    size_t rows = 1 + id % 5, cols = 1 + (id * 7) % 6;
+    std::vector<double> values(rows * cols);
+    for (size_t k = 0; k < values.size(); ++k) {
+        values[k] = id * 100.0 + k * 0.5 - (k % 3 == 0 ? 0 : 7);
+    }
+    return Matrix(values.data(), rows, cols);
+}
+
+template <typename T>
+static std::string patched(std::string bytes, size_t at, T value) {
+    std::memcpy(&bytes[at], &value, sizeof(value));
+    return bytes;
+}
+
+static std::string openError(const std::string& bytes) {
+    writeFile(DAMAGED, bytes);
+    return exceptionMessage([] { MatrixArchiveLoader loader(DAMAGED); });
+}
+
+int main() {
+    const double extremes[] = {-0.0, 1e-310, -1e308,
+                               std::numeric_limits<double>::infinity()};
+    const Matrix special(extremes, 2, 2);
+    {
+        MatrixArchiveWriter writer(ARCHIVE);
+        for (int id = 0; id < COUNT; ++id) {
+            CHECK(writer.append(sample(id)) == uint64_t(id));
+        }
+        CHECK(writer.append(Matrix("[0,0,0;0,5,0;0,0,0]")) == uint64_t(COUNT));
+        CHECK(writer.append(special) == uint64_t(COUNT + 1));
+        writer.finish();
+        CHECK(!exceptionMessage([&] { writer.append(sample(0)); }).empty());
+    }
+
+    {
+        MatrixArchiveLoader loader(ARCHIVE);
+        CHECK(loader.size() == uint64_t(COUNT + 2));
+        for (int id : {0, COUNT - 1, 17, COUNT / 2, 1}) {
+            CHECK(loader.GetItem(id) == sample(id));
+            CHECK(loader.entry(id).rows == sample(id).getRows());
+            CHECK(loader.entry(id).cols == sample(id).getCols());
+        }
+        CHECK(loader.GetItem(COUNT) == Matrix("[0,0,0;0,5,0;0,0,0]"));
+        const Matrix restored = loader.GetItem(COUNT + 1);
+        CHECK(std::memcmp(restored.data(), extremes, sizeof(extremes)) == 0);
+        CHECK(contains(exceptionMessage([&] { loader.GetItem(COUNT + 2); }),
+                       "out of range"));
+
+        int id = 0;
+        bool inOrder = true;
+        while (loader.HasNext()) {
+            Matrix item = loader.GetItem();
+            if (id < COUNT && !(item == sample(id))) inOrder = false;
+            ++id;
+        }
+        CHECK(inOrder);
+        CHECK(id == COUNT + 2);
+        CHECK(contains(exceptionMessage([&] { loader.GetItem(); }),
+                       "no more items"));
+    }
+
+    // The destructor finishes an archive; an empty one is valid.
+    { MatrixArchiveWriter writer(SMALL); }
+    {
+        MatrixArchiveLoader loader(SMALL);
+        CHECK(loader.size() == 0);
+        CHECK(!loader.HasNext());
+    }
+    {
+        MatrixArchiveWriter writer(SMALL);
+        writer.append(sample(3));
+        writer.append(sample(4));
+    }
+    {
+        MatrixArchiveLoader loader(SMALL);
+        CHECK(loader.size() == 2);
+        CHECK(loader.GetItem(1) == sample(4));
+        CHECK(loader.GetItem(0) == sample(3));
+    }
+
+    // Every strict prefix has lost at least part of the footer.
+    const std::string small = readFile(SMALL);
+    for (size_t size = 0; size < small.size(); ++size) {
+        CHECK(contains(openError(small.substr(0, size)), "truncated"));
+    }
+
+    const std::string bytes = readFile(ARCHIVE);
+    CHECK(openError(bytes).empty());
+    CHECK(contains(openError(patched<char>(bytes, 0, 'X')), "unsupported"));
+    CHECK(contains(openError(patched<uint32_t>(bytes, 8, 2)), "unsupported"));
+    CHECK(contains(openError(patched<char>(bytes, bytes.size() - 1, 'X')),
+                   "truncated"));
+
+    // The footer's index offset and count must describe the index exactly.
+    const size_t footer = bytes.size() - FOOTER_SIZE;
+    for (uint64_t offset : {uint64_t(0), uint64_t(3), uint64_t(footer + 8),
+                            ~uint64_t(0)}) {
+        CHECK(contains(openError(patched<uint64_t>(bytes, footer, offset)),
+                       "index out of bounds"));
+    }
+    CHECK(contains(openError(patched<uint64_t>(bytes, footer + 8, COUNT)),
+                   "index out of bounds"));
+
+    // A damaged id fails on its own; the rest of the archive still reads.
+    writeFile(DAMAGED, patched<char>(bytes, HEADER_SIZE + 3, 0x55));
+    {
+        MatrixArchiveLoader loader(DAMAGED);
+        CHECK(contains(exceptionMessage([&] { loader.GetItem(0); }),
+                       "checksum mismatch"));
+        CHECK(loader.GetItem(1) == sample(1));
+    }
+    const size_t lastEntry = footer - ENTRY_SIZE;
+    writeFile(DAMAGED, patched<uint64_t>(bytes, lastEntry, uint64_t(1) << 60));
+    {
+        MatrixArchiveLoader loader(DAMAGED);
+        CHECK(contains(exceptionMessage([&] { loader.GetItem(COUNT + 1); }),
+                       "values out of bounds"));
+    }
+    writeFile(DAMAGED, patched<uint64_t>(bytes, lastEntry + 8, ~uint64_t(0)));
+    {
+        MatrixArchiveLoader loader(DAMAGED);
+        CHECK(contains(exceptionMessage([&] { loader.GetItem(COUNT + 1); }),
+                       "values out of bounds"));
+    }
+
+    CHECK(contains(exceptionMessage([] {
+                       MatrixArchiveLoader loader("MatrixArchiveTest.missing");
+                   }),
+                   "Unable to open"));
+    CHECK(contains(exceptionMessage([] {
+                       MatrixArchiveWriter writer(
+                           "MatrixArchiveTest.missing/archive.mxa");
+                   }),
+                   "Unable to open"));
+
+    return testResult();
+}
@@ -0,0 +1,144 @@
+// ParallelFileLoader keeps file order with Order::Preserve for any thread
+// count and chunk size, delivers every line exactly once with Order::Any,
+// and reports a malformed line at its position and on every call after.
+
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "AsyncLoader.h"
+#include "MatrixException.h"
+#include "ParallelFileLoader.h"
+#include "TestSupport.h"
+
+static const char* LINES = "ParallelFileLoaderTest.txt";
+static const char* BAD_LINE = "ParallelFileLoaderTest.bad.txt";
+static const char* EMPTY = "ParallelFileLoaderTest.empty.txt";
+
+static const int LINE_COUNT = 5000;
+static const int BAD_AT = 600;
+
+static std::string line(int k) {
+    return "[" + std::to_string(k) + ", " + std::to_string(k + 1) + ";" +
+           std::to_string(-k) + ",+0.5e1]";
+}
+
+static bool matches(const Matrix& item, int k) {
+    return item == Matrix(line(k).c_str());
+}
+
+// Reads everything, checking file order; returns the number of items.
+static int drainInOrder(Loader& loader) {
+    int count = 0;
+    while (loader.HasNext()) {
+        if (!matches(loader.GetItem(), count)) return -1;
+        ++count;
+    }
+    return count;
+}
+
+int main() {
+    {
+        // Blank lines and CRLF endings mixed in.
+        std::ofstream out(LINES, std::ios::binary);
+        for (int k = 0; k < LINE_COUNT; ++k) {
+            out << line(k) << (k % 7 == 0 ? "\r\n" : "\n");
+            if (k % 100 == 0) out << "  \n";
+        }
+    }
+    {
+        std::ofstream out(BAD_LINE, std::ios::binary);
+        for (int k = 0; k < 1000; ++k) {
+            out << (k == BAD_AT ? std::string("[1,2;3]") : line(k)) << "\n";
+        }
+    }
+    std::ofstream(EMPTY, std::ios::binary);
+
+    for (size_t threads : {1, 3, 8}) {
+        for (size_t chunkBytes : {size_t(1), size_t(4096), size_t(1) << 20}) {
+            ParallelFileLoader loader(
+                LINES, ParallelFileLoader::Order::Preserve, threads,
+                chunkBytes);
+            CHECK(drainInOrder(loader) == LINE_COUNT);
+            CHECK(contains(exceptionMessage([&] { loader.GetItem(); }),
+                           "no more items"));
+        }
+    }
+
+    for (size_t threads : {1, 4}) {
+        ParallelFileLoader loader(LINES, ParallelFileLoader::Order::Any,
+                                  threads, 1000);
+        std::set<int> seen;
+        int count = 0;
+        while (loader.HasNext()) {
+            const Matrix item = loader.GetItem();
+            int k = static_cast<int>(item(0, 0));
+            if (matches(item, k)) seen.insert(k);
+            ++count;
+        }
+        CHECK(count == LINE_COUNT);
+        CHECK(static_cast<int>(seen.size()) == LINE_COUNT);
+    }
+
+    // Preserve: every line before the bad one, in order, then the parse
+    // error on that call and every later one.
+    for (size_t threads : {1, 4}) {
+        ParallelFileLoader loader(
+            BAD_LINE, ParallelFileLoader::Order::Preserve, threads, 500);
+        int k = 0;
+        while (k < BAD_AT && matches(loader.GetItem(), k)) ++k;
+        CHECK(k == BAD_AT);
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            bool thrown = false;
+            try {
+                loader.GetItem();
+            } catch (const InvalidMatrixFormatException&) {
+                thrown = true;
+            }
+            CHECK(thrown);
+        }
+    }
+
+    // Any: chunks may come out in any order, but the error still does
+    // and sticks.
+    {
+        ParallelFileLoader loader(BAD_LINE, ParallelFileLoader::Order::Any, 4,
+                                  500);
+        bool thrown = false;
+        try {
+            while (loader.HasNext()) loader.GetItem();
+        } catch (const InvalidMatrixFormatException&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+        CHECK(!exceptionMessage([&] { loader.GetItem(); }).empty());
+    }
+
+    // A ParallelFileLoader runs dry, so AsyncLoader can read ahead of it
+    // without changing the order.
+    {
+        AsyncLoader loader(std::make_unique<ParallelFileLoader>(
+                               LINES, ParallelFileLoader::Order::Preserve, 2,
+                               4096),
+                           8);
+        CHECK(drainInOrder(loader) == LINE_COUNT);
+    }
+
+    // Destruction with workers blocked on the window.
+    {
+        ParallelFileLoader loader(LINES, ParallelFileLoader::Order::Preserve,
+                                  4, 64);
+        CHECK(matches(loader.GetItem(), 0));
+    }
+
+    {
+        ParallelFileLoader loader(EMPTY);
+        CHECK(!loader.HasNext());
+    }
+    CHECK(!exceptionMessage([] {
+               ParallelFileLoader loader("ParallelFileLoaderTest.missing");
+           }).empty());
+
+    return testResult();
+}
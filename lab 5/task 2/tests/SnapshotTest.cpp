@@ -0,0 +1,139 @@
+// VectorAnalog::saveSnapshot / loadSnapshot: expressions survive a round
+// trip, and truncated or corrupt files are rejected with MatrixException
+// instead of being read out of bounds. Offsets below follow the layout
+// described in src/VectorAnalog.cpp.
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "ArithmeticExpression.h"
+#include "Node.h"
+#include "TestSupport.h"
+#include "VectorAnalog.h"
+
+static const char* SNAPSHOT = "SnapshotTest.bin";
+static const char* DAMAGED = "SnapshotTest.damaged.bin";
+
+static const size_t HEADER_SIZE = 48;
+static const size_t EXPRESSION_SIZE = 16;
+static const size_t NODE_SIZE = 16;
+
+static std::unique_ptr<Node> operand(const char* text) {
+    return std::make_unique<OperandNode>(Matrix(text));
+}
+
+static std::unique_ptr<Node> apply(char op, std::unique_ptr<Node> left,
+                                   std::unique_ptr<Node> right) {
+    return std::make_unique<OperatorNode>(op, std::move(left),
+                                          std::move(right));
+}
+
+static VectorAnalog sample() {
+    VectorAnalog vector;
+    vector.add(ArithmeticExpression(
+        apply('+', operand("[1,2;3,4]"), operand("[5,6;7,8]"))));
+    vector.add(ArithmeticExpression(apply(
+        '/',
+        apply('-', apply('*', operand("[1,2;3,4]"), operand("[0.5,0;0,2]")),
+              operand("[1,1;1,1]")),
+        operand("[2,4;8,16]"))));
+    vector.add(ArithmeticExpression(operand("[1.25,-3e10,7]")));
+    return vector;
+}
+
+template <typename T>
+static std::string patched(std::string bytes, size_t at, T value) {
+    std::memcpy(&bytes[at], &value, sizeof(value));
+    return bytes;
+}
+
+static std::string loadError(const std::string& bytes) {
+    writeFile(DAMAGED, bytes);
+    return exceptionMessage([] {
+        VectorAnalog vector;
+        vector.loadSnapshot(DAMAGED);
+    });
+}
+
+int main() {
+    VectorAnalog original = sample();
+    original.saveSnapshot(SNAPSHOT);
+
+    VectorAnalog loaded;
+    loaded.loadSnapshot(SNAPSHOT);
+    CHECK(loaded.size() == original.size());
+    for (size_t i = 0; i < original.size() && i < loaded.size(); ++i) {
+        CHECK(loaded[i].PrintExpression() == original[i].PrintExpression());
+        CHECK(loaded[i].Evaluate() == original[i].Evaluate());
+    }
+
+    VectorAnalog empty;
+    empty.saveSnapshot(SNAPSHOT);
+    loaded.loadSnapshot(SNAPSHOT);
+    CHECK(loaded.size() == 0);
+
+    original.saveSnapshot(SNAPSHOT);
+    const std::string bytes = readFile(SNAPSHOT);
+    CHECK(loadError(bytes).empty());
+
+    // Every strict prefix of the file is missing part of a section.
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        std::string message = loadError(bytes.substr(0, size));
+        CHECK(!message.empty());
+        if (size > 0) CHECK(contains(message, "truncated"));
+    }
+
+    // Header. Counts large enough to wrap a multiplication must not pass
+    // the size checks.
+    CHECK(contains(loadError(patched<char>(bytes, 0, 'X')), "unsupported"));
+    CHECK(contains(loadError(patched<uint32_t>(bytes, 8, 2)), "unsupported"));
+    CHECK(contains(loadError(patched<uint64_t>(bytes, 16, (1ULL << 60) + 1)),
+                   "truncated"));
+    CHECK(contains(loadError(patched<uint64_t>(bytes, 40, 1ULL << 61)),
+                   "truncated"));
+
+    // The first expression's node range.
+    size_t expressions = HEADER_SIZE;
+    CHECK(contains(loadError(patched<uint64_t>(bytes, expressions, ~0ULL)),
+                   "node range"));
+    CHECK(contains(
+        loadError(patched<uint64_t>(bytes, expressions + 8, ~0ULL)),
+        "node range"));
+
+    // The first expression is operand, operand, '+'.
+    size_t nodes = expressions + 3 * EXPRESSION_SIZE;
+    CHECK(contains(loadError(patched<uint64_t>(bytes, nodes + 8, 1000)),
+                   "operand index"));
+    CHECK(contains(loadError(patched<uint8_t>(bytes, nodes + 2 * NODE_SIZE, 7)),
+                   "unknown node"));
+    CHECK(contains(
+        loadError(patched<char>(bytes, nodes + 2 * NODE_SIZE + 1, 'x')),
+        "unknown node"));
+    CHECK(contains(loadError(patched<uint8_t>(bytes, nodes, 1)),
+                   "unknown node"));
+
+    // The first operand's shape and offset into the values.
+    size_t matrices = nodes + 11 * NODE_SIZE;
+    CHECK(contains(loadError(patched<uint64_t>(bytes, matrices, 1ULL << 62)),
+                   "values out of bounds"));
+    CHECK(contains(
+        loadError(patched<uint64_t>(bytes, matrices + 16, ~0ULL)),
+        "values out of bounds"));
+
+    // A failed load leaves the previous contents alone.
+    VectorAnalog kept = sample();
+    writeFile(DAMAGED, bytes.substr(0, bytes.size() - 1));
+    CHECK(!exceptionMessage([&] { kept.loadSnapshot(DAMAGED); }).empty());
+    CHECK(kept.size() == original.size());
+
+    CHECK(contains(exceptionMessage([] {
+                       VectorAnalog vector;
+                       vector.loadSnapshot("SnapshotTest.missing.bin");
+                   }),
+                   "Unable to open"));
+
+    return testResult();
+}
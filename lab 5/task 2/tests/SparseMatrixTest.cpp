@@ -0,0 +1,164 @@
+// Sparse (CSR) operands against a dense reference: every operator, for
+// each mix of sparse and dense operands, gives the same elements as plain
+// loops over std::vector, as do multiplyVector() and comparisons. Writes
+// through a sparse matrix land where they should.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixException.h"
+#include "TestSupport.h"
+
+struct Dense {
+    size_t rows;
+    size_t cols;
+    std::vector<double> values;
+
+    double& operator()(size_t i, size_t j) { return values[i * cols + j]; }
+    double operator()(size_t i, size_t j) const {
+        return values[i * cols + j];
+    }
+};
+
+static std::mt19937 generator(1);
+
+// Roughly density * rows * cols non-zeros in [-2, 2].
+static Dense randomDense(size_t rows, size_t cols, double density) {
+    std::uniform_real_distribution<double> unit(0, 1);
+    Dense dense = {rows, cols, std::vector<double>(rows * cols, 0)};
+    for (double& value : dense.values) {
+        if (unit(generator) < density) value = unit(generator) * 4 - 2;
+    }
+    return dense;
+}
+
+static Matrix toMatrix(const Dense& dense) {
+    return Matrix(dense.values.data(), dense.rows, dense.cols);
+}
+
+static double maxDifference(const Matrix& matrix, const Dense& expected) {
+    if (matrix.getRows() != expected.rows ||
+        matrix.getCols() != expected.cols) {
+        return INFINITY;
+    }
+    double difference = 0;
+    for (size_t i = 0; i < expected.rows; ++i) {
+        for (size_t j = 0; j < expected.cols; ++j) {
+            difference =
+                std::max(difference, std::abs(matrix(i, j) - expected(i, j)));
+        }
+    }
+    return difference;
+}
+
+static Dense elementwise(const Dense& a, const Dense& b, char op) {
+    Dense result = a;
+    for (size_t k = 0; k < result.values.size(); ++k) {
+        double x = a.values[k], y = b.values[k];
+        result.values[k] = op == '+' ? x + y : op == '-' ? x - y : x / y;
+    }
+    return result;
+}
+
+static Dense product(const Dense& a, const Dense& b) {
+    Dense result = {a.rows, b.cols, std::vector<double>(a.rows * b.cols, 0)};
+    for (size_t i = 0; i < a.rows; ++i) {
+        for (size_t k = 0; k < a.cols; ++k) {
+            for (size_t j = 0; j < b.cols; ++j) {
+                result(i, j) += a(i, k) * b(k, j);
+            }
+        }
+    }
+    return result;
+}
+
+static const double TOLERANCE = 1e-12;
+
+// Shapes of at least SPARSE_MIN_ELEMENTS (256) elements, so that the low
+// density operands are stored as CSR. operator* wants equal shapes, so
+// products are only checked for square ones.
+static void checkOperators(size_t rows, size_t cols) {
+    for (double densityA : {0.02, 0.6}) {
+        for (double densityB : {0.03, 0.5}) {
+            Dense a = randomDense(rows, cols, densityA);
+            Dense b = randomDense(rows, cols, densityB);
+            const Matrix ma = toMatrix(a), mb = toMatrix(b);
+            CHECK(ma.isSparse() == (densityA < 0.1));
+            CHECK(mb.isSparse() == (densityB < 0.1));
+
+            CHECK(maxDifference(ma, a) == 0);
+            CHECK(maxDifference(ma + mb, elementwise(a, b, '+')) <= TOLERANCE);
+            CHECK(maxDifference(ma - mb, elementwise(a, b, '-')) <= TOLERANCE);
+            CHECK(maxDifference(mb - ma, elementwise(b, a, '-')) <= TOLERANCE);
+            if (rows == cols) {
+                CHECK(maxDifference(ma * mb, product(a, b)) <=
+                      TOLERANCE * cols);
+                CHECK(maxDifference(mb * ma, product(b, a)) <=
+                      TOLERANCE * cols);
+            }
+
+            // Temporaries take the operators' buffer-reusing overloads.
+            CHECK(maxDifference(Matrix(ma) + mb, elementwise(a, b, '+')) <=
+                  TOLERANCE);
+            CHECK(maxDifference(ma - Matrix(mb), elementwise(a, b, '-')) <=
+                  TOLERANCE);
+
+            // A divisor with zeros is rejected; a full one divides
+            // elementwise.
+            CHECK(contains(exceptionMessage([&] { (void)(ma / mb); }),
+                           "Division by zero"));
+            Dense full = randomDense(rows, cols, 1.0);
+            for (double& value : full.values) value += value < 0 ? -1 : 1;
+            CHECK(maxDifference(ma / toMatrix(full),
+                                elementwise(a, full, '/')) <= TOLERANCE);
+
+            std::vector<double> x(cols);
+            for (size_t k = 0; k < cols; ++k) x[k] = 0.25 * k - 3;
+            std::vector<double> y = ma.multiplyVector(x);
+            double difference = 0;
+            for (size_t i = 0; i < rows; ++i) {
+                double expected = 0;
+                for (size_t k = 0; k < cols; ++k) expected += a(i, k) * x[k];
+                difference = std::max(difference, std::abs(y[i] - expected));
+            }
+            CHECK(difference <= TOLERANCE * cols);
+
+            // The same values compare equal whichever way they are stored.
+            Matrix dense = ma;
+            dense(0, 0) = dense(0, 0);
+            CHECK(!dense.isSparse());
+            CHECK(dense == ma);
+            CHECK(ma == dense);
+            CHECK(!(ma != dense));
+        }
+    }
+}
+
+int main() {
+    checkOperators(40, 40);
+    checkOperators(17, 17);
+    checkOperators(24, 33);
+
+    // A write through a sparse matrix hits the right element and leaves the
+    // others alone.
+    Dense a = randomDense(32, 32, 0.02);
+    Matrix written = toMatrix(a);
+    CHECK(written.isSparse());
+    written(5, 7) = 42;
+    a(5, 7) = 42;
+    CHECK(maxDifference(written, a) == 0);
+
+    // Shapes still have to agree.
+    Matrix sparse = toMatrix(randomDense(20, 20, 0.02));
+    Matrix other = toMatrix(randomDense(20, 21, 0.02));
+    CHECK(contains(exceptionMessage([&] { (void)(sparse + other); }),
+                   "dimension mismatch"));
+    CHECK(contains(exceptionMessage([&] { (void)(sparse * other); }),
+                   "dimension mismatch"));
+
+    return testResult();
+}
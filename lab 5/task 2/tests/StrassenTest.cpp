@@ -0,0 +1,121 @@
+// strassenMultiply against the classical blockedMultiply at odd orders and
+// orders that are not multiples of STRASSEN_CUTOFF, within the error bound
+// documented in Strassen.h, and Matrix::operator* picking Strassen in every
+// OverflowCheckMode without losing overflow detection.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixException.h"
+#include "OverflowCheck.h"
+#include "Strassen.h"
+#include "TestSupport.h"
+
+static std::mt19937 generator(1);
+
+template <typename T>
+static std::vector<T> randomSquare(size_t n, T scale) {
+    std::uniform_real_distribution<T> value(-1, 1);
+    std::vector<T> values(n * n);
+    for (T& v : values) v = value(generator) * scale;
+    return values;
+}
+
+template <typename T>
+static T maxAbsolute(const std::vector<T>& values) {
+    T result = 0;
+    for (T v : values) result = std::max(result, std::abs(v));
+    return result;
+}
+
+template <typename T>
+static T maxDifference(const T* a, const T* b, size_t count) {
+    T result = 0;
+    for (size_t k = 0; k < count; ++k) {
+        result = std::max(result, std::abs(a[k] - b[k]));
+    }
+    return result;
+}
+
+// Strassen.h's bound for ||C - C'|| with n0 = STRASSEN_CUTOFF, plus the
+// classical kernel's own n u, since both results carry rounding error.
+template <typename T>
+static T allowedDifference(size_t n, T maxA, T maxB) {
+    double n0 = STRASSEN_CUTOFF;
+    double strassen = std::pow(n / n0, std::log2(18.0)) * (n0 * n0 + 6 * n0) -
+                      6.0 * n;
+    double u = std::numeric_limits<T>::epsilon() / 2;
+    return static_cast<T>((std::max(strassen, 0.0) + n) * u * maxA * maxB);
+}
+
+template <typename T>
+static void checkKernels(size_t n, T scale) {
+    std::vector<T> a = randomSquare<T>(n, scale);
+    std::vector<T> b = randomSquare<T>(n, 1 / scale);
+    std::vector<T> classical(n * n), strassen(n * n);
+    blockedMultiply(a.data(), b.data(), classical.data(), n);
+    strassenMultiply(a.data(), b.data(), strassen.data(), n);
+    CHECK(maxDifference(classical.data(), strassen.data(), n * n) <=
+          allowedDifference(n, maxAbsolute(a), maxAbsolute(b)));
+}
+
+static Matrix filled(size_t n, double value) {
+    std::vector<double> values(n * n, value);
+    return Matrix(values.data(), n, n);
+}
+
+int main() {
+    for (size_t n : {1, 2, 3, 63, 64, 65, 100, 127, 129, 130, 200, 255, 257,
+                     300}) {
+        checkKernels<double>(n, 1);
+    }
+    checkKernels<double>(201, 1e100);
+    checkKernels<float>(131, 1);
+    checkKernels<float>(257, 1);
+
+    // Orders from STRASSEN_MIN_SIZE up go through Strassen in every mode
+    // and must agree with the classical kernel just the same.
+    const OverflowCheckMode saved = getOverflowCheckMode();
+    for (OverflowCheckMode mode :
+         {OverflowCheckMode::Strict, OverflowCheckMode::FloatingPointStatus,
+          OverflowCheckMode::FiniteScan}) {
+        setOverflowCheckMode(mode);
+        for (size_t n : {STRASSEN_MIN_SIZE, STRASSEN_MIN_SIZE + 1,
+                         STRASSEN_MIN_SIZE + 45}) {
+            std::vector<double> a = randomSquare<double>(n, 1);
+            std::vector<double> b = randomSquare<double>(n, 1);
+            std::vector<double> classical(n * n);
+            blockedMultiply(a.data(), b.data(), classical.data(), n);
+            const Matrix product =
+                Matrix(a.data(), n, n) * Matrix(b.data(), n, n);
+            CHECK(maxDifference(product.data(), classical.data(), n * n) <=
+                  allowedDifference(n, maxAbsolute(a), maxAbsolute(b)));
+        }
+
+        // A product that overflows is reported whichever kernel ran.
+        const size_t n = STRASSEN_MIN_SIZE;
+        CHECK(contains(exceptionMessage([&] {
+                           (void)(filled(n, 1e160) * filled(n, 1e160));
+                       }),
+                       "overflow"));
+    }
+
+    // Strict mode: operands this large fail the growth bound, so the
+    // checked classical kernel runs and the exact result n * 1e304 fits.
+    setOverflowCheckMode(OverflowCheckMode::Strict);
+    const size_t n = STRASSEN_MIN_SIZE;
+    CHECK(1e152 * 1e152 * strassenGrowthBound(n) >
+          std::numeric_limits<double>::max());
+    const Matrix large = filled(n, 1e152) * filled(n, 1e152);
+    CHECK(std::isfinite(large(0, 0)));
+    CHECK(large(n - 1, n - 1) == large(0, 0));
+    CHECK(std::abs(large(0, 0) / (n * 1e304) - 1) < 1e-12);
+
+    setOverflowCheckMode(saved);
+    return testResult();
+}
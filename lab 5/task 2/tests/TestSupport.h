@@ -0,0 +1,63 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "MatrixException.h"
+
+// Shared by the executables under tests/. CHECK records a failure and
+// carries on, so one run reports every broken expectation; main() returns
+// testResult(), which is what CTest looks at. Tests run with the build
+// directory as their working directory and keep scratch files there.
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                        #condition);                                      \
+            ++testFailures();                                             \
+        }                                                                 \
+    } while (0)
+
+inline int testResult() {
+    if (testFailures() != 0) {
+        std::printf("%d check(s) failed\n", testFailures());
+        return 1;
+    }
+    return 0;
+}
+
+// what() of the MatrixException that body throws, or "" if it returns.
+template <typename Body>
+std::string exceptionMessage(Body body) {
+    try {
+        body();
+    } catch (const MatrixException& e) {
+        return e.what();
+    }
+    return "";
+}
+
+inline bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+inline void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << bytes;
+}
+
+#endif  // TEST_SUPPORT_H